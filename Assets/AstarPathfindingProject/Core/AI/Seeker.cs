@@ -159,8 +159,19 @@ public class Seeker : MonoBehaviour {
 		RunModifiers (ModifierPass.PostProcess,p);
 	}
 	
+	static readonly int TraceModifiers = AstarTracer.Register ("Modifiers");
+	
 	/** Runs modifiers on path \a p */
 	public void RunModifiers (ModifierPass pass, Path p) {
+		AstarTracer.Begin (TraceModifiers);
+		try {
+			ApplyModifiers (pass, p);
+		} finally {
+			AstarTracer.End (TraceModifiers);
+		}
+	}
+	
+	void ApplyModifiers (ModifierPass pass, Path p) {
 		
 		//Sort the modifiers based on priority (bubble sort (slow but since it's a small list, it works good))
 		bool changed = true;
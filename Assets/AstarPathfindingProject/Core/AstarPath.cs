@@ -427,6 +427,15 @@ public class AstarPath : MonoBehaviour {
 	private static IEnumerator threadEnumerator;
 	private static Pathfinding.Util.LockFreeStack pathReturnStack = new Pathfinding.Util.LockFreeStack();
 	
+	/** Ids of the AstarTracer events */
+	static readonly int TracePath = AstarTracer.Register ("Path");
+	static readonly int TracePrepare = AstarTracer.Register ("Prepare");
+	static readonly int TraceSearch = AstarTracer.Register ("Search");
+	static readonly int TracePostSearch = AstarTracer.Register ("Post Search");
+	static readonly int TraceReturnPaths = AstarTracer.Register ("Return Paths");
+	static readonly int TraceGraphUpdate = AstarTracer.Register ("Graph Update");
+	static readonly int TraceFloodFill = AstarTracer.Register ("Flood Fill");
+	
 #endregion
 	
 	/** Shows or hides graph inspectors.
@@ -944,11 +953,17 @@ public class AstarPath : MonoBehaviour {
 	private void QueueGraphUpdatesInternal () {
 		
 		isRegisteredForUpdate = false;
+		lastGraphUpdate = Time.time;
 		
 		bool anyRequiresFloodFill = false;
 		
-		while (graphUpdateQueue.Count > 0) {
-			GraphUpdateObject ob = graphUpdateQueue.Dequeue ();
+		//Overlapping and adjacent updates of this batch are applied as one
+		List<GraphUpdateObject> updates = Pathfinding.Util.ListPool<GraphUpdateObject>.Claim (graphUpdateQueue.Count);
+		while (graphUpdateQueue.Count > 0) updates.Add (graphUpdateQueue.Dequeue ());
+		GraphUpdateBatcher.Merge (updates);
+		
+		for (int i=0;i<updates.Count;i++) {
+			GraphUpdateObject ob = updates[i];
 			
 			if (ob.requiresFloodFill) anyRequiresFloodFill = true;
 		
@@ -964,6 +979,8 @@ public class AstarPath : MonoBehaviour {
 			}
 		}
 		
+		Pathfinding.Util.ListPool<GraphUpdateObject>.Release (updates);
+		
 		if (anyRequiresFloodFill) {
 			GUOSingle guo = new GUOSingle();
 			guo.order = GraphUpdateOrder.FloodFill;
@@ -1060,11 +1077,16 @@ public class AstarPath : MonoBehaviour {
 							Debug.LogError ("Error while initializing GraphUpdates\n" + e);
 						}
 					}
+					AstarTracer.Begin (TraceGraphUpdate);
+					long updateStart = AstarMetrics.Now ();
 					try {
 						s.graph.UpdateArea (s.obj);
 					} catch (System.Exception e) {
 						Debug.LogError ("Error while updating graphs\n"+e);
 					}
+					AstarMetrics.graphUpdate.Record (AstarMetrics.Since (updateStart));
+					AstarMetrics.graphUpdates.Add (1);
+					AstarTracer.End (TraceGraphUpdate);
 				}
 			}
 		}
@@ -1124,7 +1146,15 @@ public class AstarPath : MonoBehaviour {
 				
 				try {
 					if (aguo.order == GraphUpdateOrder.GraphUpdate) {
-						aguo.graph.UpdateArea (aguo.obj);
+						AstarTracer.Begin (TraceGraphUpdate);
+						long updateStart = AstarMetrics.Now ();
+						try {
+							aguo.graph.UpdateArea (aguo.obj);
+						} finally {
+							AstarMetrics.graphUpdate.Record (AstarMetrics.Since (updateStart));
+							AstarMetrics.graphUpdates.Add (1);
+							AstarTracer.End (TraceGraphUpdate);
+						}
 					} else if (aguo.order == GraphUpdateOrder.FloodFill) {
 						astar.FloodFill ();
 					} else {
@@ -1208,6 +1238,9 @@ public class AstarPath : MonoBehaviour {
 		
 		isEditor = Application.isEditor;
 		
+		AstarTracer.ReadCommandLine ();
+		AstarMetrics.ReadCommandLine ();
+		
 		if (OnAwakeSettings != null) {
 			OnAwakeSettings ();
 		}
@@ -1405,6 +1438,24 @@ public class AstarPath : MonoBehaviour {
 			}
 		}
 		
+		//The threads are stopped, so a failed export can't leave them running
+		if (AstarTracer.exportPath != null) {
+			try {
+				AstarTracer.WriteChromeTrace (AstarTracer.exportPath);
+				Debug.Log ("Wrote pathfinding trace to " + AstarTracer.exportPath);
+			} catch (System.Exception e) {
+				Debug.LogError ("Could not write pathfinding trace to " + AstarTracer.exportPath + "\n" + e);
+			}
+		}
+		
+		if (AstarMetrics.exportPath != null) {
+			try {
+				AstarMetrics.Write (AstarMetrics.exportPath);
+			} catch (System.Exception e) {
+				Debug.LogError ("Could not write pathfinding metrics to " + AstarMetrics.exportPath + "\n" + e);
+			}
+		}
+		
 		if (logPathResults == PathLog.Heavy)
 			Debug.Log ("Returning Paths");
 		
@@ -1504,6 +1555,9 @@ public class AstarPath : MonoBehaviour {
 		
 		lastUniqueAreaIndex = 0;
 		
+		AstarTracer.Begin (TraceFloodFill);
+		long floodFillStart = AstarMetrics.Now ();
+		
 		if (floodStack == null) {
 			floodStack = new Stack<GraphNode> (1024);
 		}
@@ -1604,6 +1658,9 @@ public class AstarPath : MonoBehaviour {
 		
 		Pathfinding.Util.ListPool<GraphNode>.Release ( smallAreaList );
 		
+		AstarMetrics.floodFill.Record (AstarMetrics.Since (floodFillStart));
+		AstarMetrics.floodFills.Add (1);
+		AstarTracer.End (TraceFloodFill);
 	}
 	
 	private int nextNodeIndex = 1;
@@ -2090,6 +2147,8 @@ AstarPath.RegisterSafeUpdate (delegate () {
 		//Pop all items from the stack
 		Path p = pathReturnStack.PopAll ();
 		
+		AstarTracer.Begin (TraceReturnPaths);
+		
 		if(pathReturnPop == null) {
 			pathReturnPop = p;
 		} else {
@@ -2131,10 +2190,12 @@ AstarPath.RegisterSafeUpdate (delegate () {
 			if (counter > 5 && timeSlice) {
 				counter = 0;
 				if (System.DateTime.UtcNow.Ticks >= targetTick) {
-					return;
+					break;
 				}
 			}
 		}
+		
+		AstarTracer.End (TraceReturnPaths);
 	}
 	
 	/** Main pathfinding function (multithreaded). This function will calculate the paths in the pathfinding queue when multithreading is enabled.
@@ -2181,6 +2242,7 @@ AstarPath.RegisterSafeUpdate (delegate () {
 					throw new System.Exception ("Thread Error");
 				}
 				
+				AstarTracer.Begin (TracePath);
 				AstarProfiler.StartFastProfile (0);
 				p.PrepareBase (runData);
 				
@@ -2196,9 +2258,12 @@ AstarPath.RegisterSafeUpdate (delegate () {
 				//Tick for when the path started, used for calculating how long time the calculation took
 				long startTicks = System.DateTime.UtcNow.Ticks;
 				long totalTicks = 0;
+				long waitTicks = startTicks - p.callTime.Ticks;
 				
 				//Prepare the path
+				AstarTracer.Begin (TracePrepare);
 				p.Prepare ();
+				AstarTracer.End (TracePrepare);
 				
 				AstarProfiler.EndFastProfile (0);
 				
@@ -2220,7 +2285,9 @@ AstarPath.RegisterSafeUpdate (delegate () {
 						//The function will return when it has taken too much time
 						//or when it has finished calculation
 						AstarProfiler.StartFastProfile (2);
+						AstarTracer.Begin (TraceSearch);
 						p.CalculateStep (targetTick);
+						AstarTracer.End (TraceSearch);
 						p.searchIterations++;
 						
 						AstarProfiler.EndFastProfile (2);
@@ -2248,10 +2315,13 @@ AstarPath.RegisterSafeUpdate (delegate () {
 					
 				}
 				
+				AstarMetrics.RecordPath (p, runData, waitTicks);
+				
 				// Cleans up node tagging and other things
 				p.Cleanup ();
 				
 				AstarProfiler.StartFastProfile (9);
+				AstarTracer.Begin (TracePostSearch);
 				
 				//Log path results
 				astar.LogPathResults (p);
@@ -2267,6 +2337,8 @@ AstarPath.RegisterSafeUpdate (delegate () {
 				//Will advance to ReturnQueue
 				p.AdvanceState (PathState.ReturnQueue);
 				
+				AstarTracer.End (TracePostSearch);
+				AstarTracer.End (TracePath);
 				AstarProfiler.EndFastProfile (9);
 				
 				//Wait a bit if we have calculated a lot of paths
@@ -2370,13 +2442,16 @@ AstarPath.RegisterSafeUpdate (delegate () {
 			//Tick for when the path started, used for calculating how long time the calculation took
 			long startTicks = System.DateTime.UtcNow.Ticks;
 			long totalTicks = 0;
+			long waitTicks = startTicks - p.callTime.Ticks;
 			
 			AstarProfiler.StartFastProfile(8);
 			
 			AstarProfiler.StartFastProfile(0);
 			//Prepare the path
 			AstarProfiler.StartProfile ("Path Prepare");
+			AstarTracer.Begin (TracePrepare);
 			p.Prepare ();
+			AstarTracer.End (TracePrepare);
 			AstarProfiler.EndProfile ("Path Prepare");
 			AstarProfiler.EndFastProfile (0);
 			
@@ -2398,7 +2473,9 @@ AstarPath.RegisterSafeUpdate (delegate () {
 					AstarProfiler.StartFastProfile(2);
 					
 					AstarProfiler.StartProfile ("Path Calc Step");
+					AstarTracer.Begin (TraceSearch);
 					p.CalculateStep (targetTick);
+					AstarTracer.End (TraceSearch);
 					AstarProfiler.EndFastProfile(2);
 					p.searchIterations++;
 					
@@ -2433,11 +2510,14 @@ AstarPath.RegisterSafeUpdate (delegate () {
 				
 			}
 			
+			AstarMetrics.RecordPath (p, runData, waitTicks);
+			
 			// Cleans up node tagging and other things
 			p.Cleanup ();
 			
 			//Log path results
 			AstarProfiler.StartProfile ("Log Path Results");
+			AstarTracer.Begin (TracePostSearch);
 			active.LogPathResults (p);
 			AstarProfiler.EndProfile ();
 			
@@ -2448,6 +2528,7 @@ AstarPath.RegisterSafeUpdate (delegate () {
 				OnPathPostSearch (p);
 			}
 			AstarProfiler.EndFastProfile(13);
+			AstarTracer.End (TracePostSearch);
 			
 			//Push the path onto the return stack
 			//It will be detected by the main Unity thread and returned as fast as possible (the next late update)
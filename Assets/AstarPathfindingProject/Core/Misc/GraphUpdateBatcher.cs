@@ -0,0 +1,114 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+namespace Pathfinding {
+	/** Merges graph updates that were queued together into fewer, larger updates.
+	 * AstarPath applies all the updates queued within #AstarPath.maxGraphUpdateFreq in one work item, while the path threads are blocked,
+	 * and runs a single flood fill at the end. Before that, this class merges updates whose bounds overlap or touch into one update.
+	 * A pair is merged only when the merged rectangle (on the XZ plane) is at most #slack larger than the two rectangles together.
+	 * So two adjacent buildings, or the old and new bounds of a DynamicGridObstacle, become one update, while distant ones stay separate.
+	 *
+	 * Only plain GraphUpdateObjects with the same settings, no penalty, no shape and no tracked nodes are merged.
+	 * Applying any other kind once over an overlap would not give the same result as applying both.
+	 * The merged rectangle can cover nodes outside of both updates (the missing corner of an L shaped pair).
+	 * Only physics rechecks that don't reset penalties may touch those nodes, since a recheck just recomputes them from the colliders.
+	 * Updates that set walkability or tags, or reset penalties, are only merged when one rectangle contains the other.
+	 * An update is not moved before an earlier update that it overlaps.
+	 *
+	 * The counts are in AstarMetrics (astar_graph_update_objects, astar_graph_update_objects_merged, astar_graph_update_batches).
+	 */
+	public static class GraphUpdateBatcher {
+
+		public static bool enabled = true;
+
+		/** Two updates are merged if the merged area is at most this fraction larger than the sum of their areas */
+		public static float slack = 0.25f;
+
+		public static readonly AstarMetrics.Counter submitted = AstarMetrics.GetCounter ("astar_graph_update_objects");
+		public static readonly AstarMetrics.Counter merged = AstarMetrics.GetCounter ("astar_graph_update_objects_merged");
+		public static readonly AstarMetrics.Counter batches = AstarMetrics.GetCounter ("astar_graph_update_batches");
+
+		/** Merges the updates of a batch in place, keeping their order */
+		public static void Merge (List<GraphUpdateObject> updates) {
+			submitted.Add (updates.Count);
+			batches.Add (1);
+			if (!enabled) return;
+
+			bool changed = true;
+			while (changed) {
+				changed = false;
+				for (int i=0;i<updates.Count;i++) {
+					for (int j=i+1;j<updates.Count;j++) {
+						GraphUpdateObject a = updates[i];
+						GraphUpdateObject b = updates[j];
+						if (!CanMerge (a,b)) continue;
+
+						Bounds bounds = a.bounds;
+						bounds.Encapsulate (b.bounds);
+						if (ChangesNodes (a)) {
+							if (!Contains (a.bounds, b.bounds) && !Contains (b.bounds, a.bounds)) continue;
+						} else if (Area (bounds) > (Area (a.bounds)+Area (b.bounds))*(1+slack)) continue;
+						if (Overlapped (updates, i, j, bounds)) continue;
+
+						updates[i] = Copy (a, bounds);
+						updates.RemoveAt (j);
+						merged.Add (1);
+						changed = true;
+						j = i;
+					}
+				}
+			}
+		}
+
+		static bool CanMerge (GraphUpdateObject a, GraphUpdateObject b) {
+			return a.GetType () == typeof(GraphUpdateObject) && b.GetType () == typeof(GraphUpdateObject) &&
+				a.addPenalty == 0 && b.addPenalty == 0 &&
+				a.shape == null && b.shape == null &&
+				!a.trackChangedNodes && !b.trackChangedNodes &&
+				a.nnConstraint == b.nnConstraint &&
+				a.requiresFloodFill == b.requiresFloodFill &&
+				a.updatePhysics == b.updatePhysics &&
+				a.resetPenaltyOnPhysics == b.resetPenaltyOnPhysics &&
+				a.updateErosion == b.updateErosion &&
+				a.modifyWalkability == b.modifyWalkability && a.setWalkability == b.setWalkability &&
+				a.modifyTag == b.modifyTag && a.setTag == b.setTag;
+		}
+
+		/** True if applying \a a to nodes outside of its bounds would change them, not only recheck them */
+		static bool ChangesNodes (GraphUpdateObject a) {
+			return a.modifyWalkability || a.modifyTag || (a.updatePhysics && a.resetPenaltyOnPhysics);
+		}
+
+		/** True if \a outer contains \a inner on the XZ plane */
+		static bool Contains (Bounds outer, Bounds inner) {
+			return outer.min.x <= inner.min.x && outer.max.x >= inner.max.x && outer.min.z <= inner.min.z && outer.max.z >= inner.max.z;
+		}
+
+		/** True if an update between \a i and \a j touches \a bounds, then \a j can't be applied at \a i */
+		static bool Overlapped (List<GraphUpdateObject> updates, int i, int j, Bounds bounds) {
+			for (int k=i+1;k<j;k++) {
+				Bounds other = updates[k].bounds;
+				if (other.min.x <= bounds.max.x && other.max.x >= bounds.min.x && other.min.z <= bounds.max.z && other.max.z >= bounds.min.z) return true;
+			}
+			return false;
+		}
+
+		static GraphUpdateObject Copy (GraphUpdateObject a, Bounds bounds) {
+			GraphUpdateObject ob = new GraphUpdateObject (bounds);
+			ob.nnConstraint = a.nnConstraint;
+			ob.requiresFloodFill = a.requiresFloodFill;
+			ob.updatePhysics = a.updatePhysics;
+			ob.resetPenaltyOnPhysics = a.resetPenaltyOnPhysics;
+			ob.updateErosion = a.updateErosion;
+			ob.modifyWalkability = a.modifyWalkability;
+			ob.setWalkability = a.setWalkability;
+			ob.modifyTag = a.modifyTag;
+			ob.setTag = a.setTag;
+			return ob;
+		}
+
+		static float Area (Bounds b) {
+			return b.size.x*b.size.z;
+		}
+	}
+}
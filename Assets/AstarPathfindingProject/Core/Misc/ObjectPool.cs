@@ -1,5 +1,5 @@
 //#define ASTAR_NO_POOLING //Disable pooling for some reason. Could be debugging or just for measuring the difference.
-//#define ASTAR_OPTIMIZE_POOLING //Skip some error checking for pooling. Optimizes Release calls to O(1) instead of O(n) where n is the number of objects in the pool.
+//#define ASTAR_OPTIMIZE_POOLING //Skip some error checking for pooling. Optimizes Release calls to O(1) instead of O(m) where m is the magazine size.
 
 using System;
 using System.Collections.Generic;
@@ -21,35 +21,21 @@ namespace Pathfinding.Util
 	 * 
 	 * After you have released a object, you should never use it again.
 	 * 
-	 * \warning This class is not thread safe
+	 * Thread safe: every thread has its own magazine of objects, see PoolMagazines. Counters in #Stats.
 	 * 
 	 * \since Version 3.2
 	 * \see Pathfinding.Util.ListPool
 	 */
 	public static class ObjectPool<T> where T : class, IAstarPooledObject, new()
 	{
-		/** Internal pool */
-		static List<T> pool;
-		
-		/** Static constructor initializing the internal pool list */
-		static ObjectPool ()
-		{
-			pool = new List<T> ();
-		}
-		
 		/** Claim a object.
 		 * Returns a pooled object if any are in the pool.
 		 * Otherwise it creates a new one.
 		 * After usage, this object should be released using the Release function (though not strictly necessary).
 		 */
 		public static T Claim () {
-			if (pool.Count > 0) {
-				T ls = pool[pool.Count-1];
-				pool.RemoveAt(pool.Count-1);
-				return ls;
-			} else {
-				return new T ();
-			}
+			T obj = PoolMagazines<T>.Claim (0);
+			return obj ?? new T ();
 		}
 		
 		/** Makes sure the pool contains at least \a count pooled items with capacity \a size.
@@ -65,30 +51,36 @@ namespace Pathfinding.Util
 		 * After the object has been released it should not be used anymore.
 		 * 
 		 * \throws System.InvalidOperationException
-		 * Releasing an object when it has already been released will cause an exception to be thrown.
-		 * However enabling ASTAR_OPTIMIZE_POOLING will prevent this check, making this function an O(1) operation instead of O(n).
+		 * Releasing an object when it has already been released by the same thread will cause an exception to be thrown.
+		 * However enabling ASTAR_OPTIMIZE_POOLING will prevent this check, making this function an O(1) operation instead of O(m).
 		 * 
 		 * \see Claim
 		 */
 		public static void Release (T obj) {
 			
-			for (int i=0;i<pool.Count;i++)
-				if (pool[i] == obj)
-					throw new System.InvalidOperationException ("The object is released even though it is in the pool. Are you releasing it twice?");
+#if !ASTAR_OPTIMIZE_POOLING
+			if (PoolMagazines<T>.Pooled (obj, 0))
+				throw new System.InvalidOperationException ("The object is released even though it is in the pool. Are you releasing it twice?");
+#endif
 			obj.OnEnterPool();
-			pool.Add (obj);
+			PoolMagazines<T>.Release (obj, 0);
 		}
 		
 		/** Clears the pool for objects of this type.
 		 * This is an O(n) operation, where n is the number of pooled objects.
 		 */
 		public static void Clear () {
-			pool.Clear ();
+			PoolMagazines<T>.Clear ();
 		}
 		
-		/** Number of objects of this type in the pool */
+		/** Number of objects of this type in the pool, the magazines of other threads are not included */
 		public static int GetSize () {
-			return pool.Count;
+			return PoolMagazines<T>.Size ();
+		}
+		
+		/** Hit rate and contention counters */
+		public static PoolStats Stats {
+			get { return PoolMagazines<T>.stats; }
 		}
 	}
 }
@@ -0,0 +1,250 @@
+using System;
+using System.Collections.Generic;
+using System.Threading;
+
+namespace Pathfinding.Util
+{
+	/** Counters of a pool.
+	 * Claims served by the magazine of a thread and releases are counted by that thread and added to
+	 * the totals when it visits the depot, so they can lag a bit behind.
+	 *
+	 * \see Pathfinding.Util.PoolMagazines
+	 */
+	public class PoolStats
+	{
+		public readonly string name;
+
+		public long hits;			/**< Claims served from the magazine of the thread */
+		public long depotHits;		/**< Claims served by refilling the magazine from the depot */
+		public long misses;			/**< Claims that had to create a new object */
+		public long releases;
+		public long contention;		/**< Depot visits that had to wait for another thread */
+		public int depotSize;		/**< Objects in the depot, the magazines of the threads are not included */
+
+		static readonly List<PoolStats> all = new List<PoolStats> ();
+
+		public PoolStats (string name) {
+			this.name = name;
+			lock (all) {
+				all.Add (this);
+			}
+		}
+
+		/** Stats of all the pools used so far */
+		public static PoolStats[] All {
+			get {
+				lock (all) {
+					return all.ToArray ();
+				}
+			}
+		}
+
+		/** Fraction of the claims that didn't create a new object */
+		public float HitRate {
+			get {
+				long claims = hits + depotHits + misses;
+				return claims == 0 ? 0 : (float)(hits + depotHits) / claims;
+			}
+		}
+
+		public override string ToString () {
+			return name + ": hit rate " + HitRate.ToString ("0.000") + " (" + hits + " local, " + depotHits + " depot, " + misses + " misses), " +
+				releases + " releases, " + contention + " contended, " + depotSize + " in depot";
+		}
+	}
+
+	/** Thread local magazines backed by a global depot, used by ListPool, StackPool and ObjectPool.
+	 *
+	 * Every thread claims from and releases to its own magazine without locking.
+	 * Objects are kept in size classes (buckets), bucket \a b of ListPool holds lists with a capacity of at least 2^b,
+	 * so a claim with a capacity checks at most #Buckets buckets instead of searching the pooled lists.
+	 *
+	 * When a bucket of a magazine is empty it is refilled with half a magazine from the depot, and when it is full
+	 * half of it is moved to the depot, so the depot lock is taken at most once every MagazineSize/2 claims or releases.
+	 *
+	 * Clear increments a generation, the magazines of other threads are dropped the next time they are used.
+	 *
+	 * \since Version 3.2
+	 * \see Pathfinding.Util.PoolStats
+	 */
+	public static class PoolMagazines<T> where T : class
+	{
+		public const int Buckets = 16;
+
+		/** Objects per bucket in the magazine of a thread */
+		const int MagazineSize = 32;
+
+		class Magazine {
+			public T[][] items = new T[Buckets][];
+			public int[] counts = new int[Buckets];
+			public int generation;
+			public long hits;
+			public long releases;
+		}
+
+		[ThreadStatic]
+		static Magazine local;
+
+		static readonly List<T>[] depot;
+		static readonly object depotLock = new object ();
+		static volatile int generation;
+
+		public static readonly PoolStats stats;
+
+		static PoolMagazines ()
+		{
+			depot = new List<T>[Buckets];
+			for (int i=0;i<Buckets;i++) depot[i] = new List<T> ();
+			stats = new PoolStats (Name (typeof(T)));
+		}
+
+		/** An object of \a bucket or of a larger bucket.
+		 * Returns null if the pool is empty, the caller creates a new object then.
+		 */
+		public static T Claim (int bucket) {
+			Magazine m = Local ();
+			for (int b=bucket;b<Buckets;b++) {
+				if (m.counts[b] > 0) {
+					m.hits++;
+					return Pop (m, b);
+				}
+			}
+
+			Enter ();
+			try {
+				Flush (m);
+				for (int b=bucket;b<Buckets;b++) {
+					List<T> d = depot[b];
+					if (d.Count == 0) continue;
+
+					int n = Math.Min (d.Count, MagazineSize/2);
+					T[] items = Items (m, b);
+					for (int i=0;i<n;i++) items[m.counts[b]++] = d[d.Count-n+i];
+					d.RemoveRange (d.Count-n, n);
+					stats.depotSize -= n;
+					stats.depotHits++;
+					return Pop (m, b);
+				}
+				stats.misses++;
+				return null;
+			} finally {
+				Monitor.Exit (depotLock);
+			}
+		}
+
+		/** Add an object to \a bucket.
+		 * The object must not be pooled already, see #Pooled.
+		 */
+		public static void Release (T item, int bucket) {
+			Magazine m = Local ();
+			T[] items = Items (m, bucket);
+
+			if (m.counts[bucket] == MagazineSize) {
+				Enter ();
+				try {
+					Flush (m);
+					int n = MagazineSize/2;
+					for (int i=MagazineSize-n;i<MagazineSize;i++) {
+						depot[bucket].Add (items[i]);
+						items[i] = null;
+					}
+					m.counts[bucket] -= n;
+					stats.depotSize += n;
+				} finally {
+					Monitor.Exit (depotLock);
+				}
+			}
+
+			items[m.counts[bucket]++] = item;
+			m.releases++;
+		}
+
+		/** True if \a item is in the magazine of this thread.
+		 * Only this magazine is checked, objects released twice from different threads are not detected.
+		 */
+		public static bool Pooled (T item, int bucket) {
+			Magazine m = Local ();
+			T[] items = m.items[bucket];
+			for (int i=0;i<m.counts[bucket];i++) if (items[i] == item) return true;
+			return false;
+		}
+
+		/** Objects in the depot plus the ones in the magazine of this thread */
+		public static int Size () {
+			Magazine m = Local ();
+			int size = stats.depotSize;
+			for (int b=0;b<Buckets;b++) size += m.counts[b];
+			return size;
+		}
+
+		/** Empties the depot, the magazines of the threads are dropped the next time they are used */
+		public static void Clear () {
+			lock (depotLock) {
+				for (int b=0;b<Buckets;b++) depot[b].Clear ();
+				stats.depotSize = 0;
+				generation++;
+			}
+		}
+
+		/** Smallest bucket whose objects have at least \a capacity */
+		public static int BucketFor (int capacity) {
+			int bucket = 0;
+			while (bucket < Buckets-1 && (1 << bucket) < capacity) bucket++;
+			return bucket;
+		}
+
+		/** Bucket of an object with \a capacity */
+		public static int BucketOf (int capacity) {
+			int bucket = 0;
+			while (bucket < Buckets-1 && (2 << bucket) <= capacity) bucket++;
+			return bucket;
+		}
+
+		static Magazine Local () {
+			Magazine m = local;
+			if (m == null || m.generation != generation) {
+				m = new Magazine ();
+				m.generation = generation;
+				local = m;
+			}
+			return m;
+		}
+
+		static T[] Items (Magazine m, int bucket) {
+			if (m.items[bucket] == null) m.items[bucket] = new T[MagazineSize];
+			return m.items[bucket];
+		}
+
+		static T Pop (Magazine m, int bucket) {
+			int i = --m.counts[bucket];
+			T item = m.items[bucket][i];
+			m.items[bucket][i] = null;
+			return item;
+		}
+
+		/** Take the depot lock, counting the times it was held by another thread */
+		static void Enter () {
+			if (!Monitor.TryEnter (depotLock)) {
+				Interlocked.Increment (ref stats.contention);
+				Monitor.Enter (depotLock);
+			}
+		}
+
+		/** Add the counters of the magazine to the stats, with the depot lock taken */
+		static void Flush (Magazine m) {
+			stats.hits += m.hits;
+			stats.releases += m.releases;
+			m.hits = 0;
+			m.releases = 0;
+		}
+
+		/** Readable name of a type, List<GraphNode> instead of System.Collections.Generic.List`1[...] */
+		static string Name (Type type) {
+			if (!type.IsGenericType) return type.Name;
+			string name = type.Name.Substring (0, type.Name.IndexOf ('`')) + "<";
+			Type[] args = type.GetGenericArguments ();
+			for (int i=0;i<args.Length;i++) name += (i > 0 ? ", " : "") + Name (args[i]);
+			return name + ">";
+		}
+	}
+}
@@ -16,35 +16,21 @@ namespace Pathfinding.Util
 	 * You do not need to clear the stack before releasing it.
 	 * After you have released a stack, you should never use it again.
 	 * 
-	 * \warning This class is not thread safe
+	 * Thread safe: every thread has its own magazine of stacks, see PoolMagazines. Counters in #Stats.
 	 * 
 	 * \since Version 3.2
 	 * \see Pathfinding.Util.ListPool
 	 */
 	public static class StackPool<T>
 	{
-		/** Internal pool */
-		static List<Stack<T>> pool;
-		
-		/** Static constructor */
-		static StackPool ()
-		{
-			pool = new List<Stack<T>> ();
-		}
-		
 		/** Claim a stack.
 		 * Returns a pooled stack if any are in the pool.
 		 * Otherwise it creates a new one.
 		 * After usage, this stack should be released using the Release function (though not strictly necessary).
 		 */
 		public static Stack<T> Claim () {
-			if (pool.Count > 0) {
-				Stack<T> ls = pool[pool.Count-1];
-				pool.RemoveAt(pool.Count-1);
-				return ls;
-			} else {
-				return new Stack<T>();
-			}
+			Stack<T> stack = PoolMagazines<Stack<T>>.Claim (0);
+			return stack ?? new Stack<T>();
 		}
 		
 		/** Makes sure the pool contains at least \a count pooled items.
@@ -58,26 +44,33 @@ namespace Pathfinding.Util
 		
 		/** Releases a stack.
 		 * After the stack has been released it should not be used anymore.
-		 * Releasing a stack twice will cause an error.
+		 * Releasing a stack twice from the same thread will cause an error.
 		 */
 		public static void Release (Stack<T> stack) {
-			for (int i=0;i<pool.Count;i++)
-				if (pool[i] == stack) UnityEngine.Debug.LogError ("The Stack is released even though it is inside the pool");
+			if (PoolMagazines<Stack<T>>.Pooled (stack, 0)) {
+				UnityEngine.Debug.LogError ("The Stack is released even though it is inside the pool");
+				return;
+			}
 			
 			stack.Clear ();
-			pool.Add (stack);
+			PoolMagazines<Stack<T>>.Release (stack, 0);
 		}
 		
 		/** Clears all pooled stacks of this type.
 		 * This is an O(n) operation, where n is the number of pooled stacks
 		 */
 		public static void Clear () {
-			pool.Clear ();
+			PoolMagazines<Stack<T>>.Clear ();
 		}
 		
-		/** Number of stacks of this type in the pool */
+		/** Number of stacks of this type in the pool, the magazines of other threads are not included */
 		public static int GetSize () {
-			return pool.Count;
+			return PoolMagazines<Stack<T>>.Size ();
+		}
+		
+		/** Hit rate and contention counters */
+		public static PoolStats Stats {
+			get { return PoolMagazines<Stack<T>>.stats; }
 		}
 	}
 }
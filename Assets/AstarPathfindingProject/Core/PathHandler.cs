@@ -102,9 +102,13 @@ namespace Pathfinding
 		/** ID for the path currently being calculated or last path that was calculated */
 		public ushort PathID {get { return pathID; }}
 		
+		/** Largest number of nodes in the heap during the current path, see AstarMetrics */
+		public int peakHeapSize;
+		
 		/** Push a node to the heap */
 		public void PushNode (PathNode node) {
 			heap.Add (node);
+			if (heap.numberOfItems > peakHeapSize) peakHeapSize = heap.numberOfItems;
 		}
 		
 		/** Pop the node with the lowest F score off the heap */
@@ -162,6 +166,7 @@ namespace Pathfinding
 		public void InitializeForPath (Path p) {
 			pathID = p.pathID;
 			heap.Clear ();
+			peakHeapSize = 0;
 		}
 		
 		/** Internal method to clean up node data */
@@ -91,15 +91,9 @@ public class DynamicGridObstacle : MonoBehaviour {
 		Bounds newBounds = col.bounds;
 		
 		//if (!simple) {
-			Bounds merged = newBounds;
-			merged.Encapsulate (prevBounds);
-			
-			if (BoundsVolume (merged) < BoundsVolume (newBounds)+BoundsVolume(prevBounds)) {
-				AstarPath.active.UpdateGraphs (merged);
-			} else {
-				AstarPath.active.UpdateGraphs (prevBounds);
-				AstarPath.active.UpdateGraphs (newBounds);
-			}
+			//GraphUpdateBatcher merges both into one update when they overlap, together with the other updates of the batch
+			AstarPath.active.UpdateGraphs (prevBounds);
+			AstarPath.active.UpdateGraphs (newBounds);
 		/*} else {
 			GraphUpdateObject guo = new GraphUpdateObject (prevBounds);
 			guo.updatePhysics = false;
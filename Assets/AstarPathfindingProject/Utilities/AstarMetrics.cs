@@ -0,0 +1,245 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Threading;
+using Pathfinding.Util;
+using Stopwatch = System.Diagnostics.Stopwatch;
+
+namespace Pathfinding {
+	/** Counters and histograms of the pathfinding system, for headless runs and CI.
+	 * AstarDebugger only shows its statistics in OnGUI, these can be written to a file or stdout instead.
+	 *
+	 * Recording is lock free (Interlocked), so it can be done from the path threads and the graph update thread.
+	 * The paths are recorded by the pathfinding loop and the graph updates by AstarPath,
+	 * more metrics can be registered with GetCounter and GetHistogram.
+	 *
+	 * Write outputs the metrics in the Prometheus text format, together with the pool sizes (see Pathfinding.Util.PoolStats),
+	 * the pooled ABPath totals and the managed heap size and collection counts, like the ones AstarDebugger shows.
+	 * With the command line argument -astarMetrics \<file\> (or - for stdout) they are written when AstarPath is destroyed.
+	 *
+	 * \see AstarTracer
+	 */
+	public static class AstarMetrics {
+
+		public class Counter {
+			public readonly string name;
+			long value;
+
+			public Counter (string name) {
+				this.name = name;
+			}
+
+			public long Value { get { return Interlocked.Read (ref value); } }
+
+			public void Add (long amount) {
+				Interlocked.Add (ref value, amount);
+			}
+
+			public void Reset () {
+				Interlocked.Exchange (ref value, 0);
+			}
+		}
+
+		/** Histogram with exponential buckets, 4 per power of two starting at #min.
+		 * Quantiles are estimated from the buckets, so they are accurate to about 10%.
+		 */
+		public class Histogram {
+			public const int Buckets = 96;
+			const int BucketsPerOctave = 4;
+
+			public readonly string name;
+			public readonly double min;
+
+			readonly long[] counts = new long[Buckets];
+			long count;
+			double sum;
+			double max;
+
+			public Histogram (string name, double min) {
+				this.name = name;
+				this.min = min;
+			}
+
+			public long Count { get { return Interlocked.Read (ref count); } }
+			public double Sum { get { return sum; } }
+			public double Max { get { return max; } }
+			public double Mean { get { long c = Count; return c == 0 ? 0 : sum/c; } }
+
+			public void Record (double value) {
+				int bucket = value <= min ? 0 : Math.Min (Buckets-1, (int)Math.Ceiling (Math.Log (value/min, 2)*BucketsPerOctave));
+				Interlocked.Increment (ref counts[bucket]);
+				Interlocked.Increment (ref count);
+
+				double old;
+				do {
+					old = sum;
+				} while (Interlocked.CompareExchange (ref sum, old+value, old) != old);
+
+				while (value > (old = max)) {
+					if (Interlocked.CompareExchange (ref max, value, old) == old) break;
+				}
+			}
+
+			/** Upper bound of the bucket that holds the \a q quantile, q in [0,1] */
+			public double Quantile (double q) {
+				long total = Count;
+				if (total == 0) return 0;
+
+				long rank = (long)Math.Ceiling (q*total);
+				long seen = 0;
+				for (int i=0;i<Buckets;i++) {
+					seen += Interlocked.Read (ref counts[i]);
+					if (seen >= rank) return Math.Min (max, min*Math.Pow (2, (double)i/BucketsPerOctave));
+				}
+				return max;
+			}
+
+			public void Reset () {
+				for (int i=0;i<Buckets;i++) Interlocked.Exchange (ref counts[i], 0);
+				Interlocked.Exchange (ref count, 0);
+				Interlocked.Exchange (ref sum, 0);
+				Interlocked.Exchange (ref max, 0);
+			}
+		}
+
+		static readonly List<Counter> counters = new List<Counter> ();
+		static readonly List<Histogram> histograms = new List<Histogram> ();
+
+		public static readonly Counter pathsCompleted = GetCounter ("astar_paths_completed");
+		public static readonly Counter pathsFailed = GetCounter ("astar_paths_failed");
+		public static readonly Counter graphUpdates = GetCounter ("astar_graph_updates");
+		public static readonly Counter floodFills = GetCounter ("astar_flood_fills");
+
+		/** Time from the path call to the start of its search, in ms */
+		public static readonly Histogram pathQueueWait = GetHistogram ("astar_path_queue_wait_ms", 0.001);
+		/** Time spent searching, in ms (Path.duration) */
+		public static readonly Histogram pathCompute = GetHistogram ("astar_path_compute_ms", 0.001);
+		public static readonly Histogram searchedNodes = GetHistogram ("astar_path_searched_nodes", 1);
+		/** Peak size of the open list (binary heap) of each path, not a memory size */
+		public static readonly Histogram heapSize = GetHistogram ("astar_path_heap_size", 1);
+		public static readonly Histogram graphUpdate = GetHistogram ("astar_graph_update_ms", 0.001);
+		public static readonly Histogram floodFill = GetHistogram ("astar_flood_fill_ms", 0.001);
+
+		/** File the metrics are written to when AstarPath is destroyed, "-" for stdout. Set by the -astarMetrics argument */
+		public static string exportPath;
+
+		public static Counter GetCounter (string name) {
+			lock (counters) {
+				for (int i=0;i<counters.Count;i++) if (counters[i].name == name) return counters[i];
+				Counter c = new Counter (name);
+				counters.Add (c);
+				return c;
+			}
+		}
+
+		/** Histogram \a name, \a min is the upper bound of the first bucket */
+		public static Histogram GetHistogram (string name, double min) {
+			lock (histograms) {
+				for (int i=0;i<histograms.Count;i++) if (histograms[i].name == name) return histograms[i];
+				Histogram h = new Histogram (name, min);
+				histograms.Add (h);
+				return h;
+			}
+		}
+
+		/** Timestamp for #Since */
+		public static long Now () {
+			return Stopwatch.GetTimestamp ();
+		}
+
+		/** Milliseconds since \a timestamp, see #Now */
+		public static double Since (long timestamp) {
+			return (Stopwatch.GetTimestamp ()-timestamp)*1000.0/Stopwatch.Frequency;
+		}
+
+		/** Records a finished search, called by the pathfinding loop before the path is cleaned up.
+		 * \param waitTicks DateTime ticks between the path call and the start of the search
+		 */
+		public static void RecordPath (Path p, PathHandler handler, long waitTicks) {
+			if (p.CompleteState == PathCompleteState.Error) pathsFailed.Add (1);
+			else pathsCompleted.Add (1);
+
+			pathQueueWait.Record (Math.Max (0, waitTicks*0.0001));
+			pathCompute.Record (p.duration);
+			searchedNodes.Record (p.searchedNodes);
+			heapSize.Record (handler.peakHeapSize);
+		}
+
+		/** Reads the -astarMetrics argument, called by AstarPath.Awake */
+		public static void ReadCommandLine () {
+			string[] args = Environment.GetCommandLineArgs ();
+			for (int i=0;i<args.Length-1;i++) {
+				if (args[i] == "-astarMetrics") exportPath = args[i+1];
+			}
+		}
+
+		public static void Reset () {
+			lock (counters) {
+				for (int i=0;i<counters.Count;i++) counters[i].Reset ();
+			}
+			lock (histograms) {
+				for (int i=0;i<histograms.Count;i++) histograms[i].Reset ();
+			}
+		}
+
+		/** Writes the metrics to \a path, or to stdout if it is "-" */
+		public static void Write (string path) {
+			if (path == "-") {
+				Write (Console.Out);
+				Console.Out.Flush ();
+			} else {
+				using (var writer = new StreamWriter (path, false)) {
+					Write (writer);
+				}
+			}
+		}
+
+		/** Writes the metrics in the Prometheus text format */
+		public static void Write (TextWriter writer) {
+			var culture = System.Globalization.CultureInfo.InvariantCulture;
+
+			Counter[] cs;
+			lock (counters) {
+				cs = counters.ToArray ();
+			}
+			for (int i=0;i<cs.Length;i++) {
+				writer.WriteLine ("# TYPE " + cs[i].name + " counter");
+				writer.WriteLine (cs[i].name + " " + cs[i].Value);
+			}
+
+			Histogram[] hs;
+			lock (histograms) {
+				hs = histograms.ToArray ();
+			}
+			double[] quantiles = {0.5, 0.9, 0.99};
+			for (int i=0;i<hs.Length;i++) {
+				Histogram h = hs[i];
+				writer.WriteLine ("# TYPE " + h.name + " summary");
+				for (int q=0;q<quantiles.Length;q++) {
+					writer.WriteLine (h.name + "{quantile=\"" + quantiles[q].ToString (culture) + "\"} " + h.Quantile (quantiles[q]).ToString ("0.###", culture));
+				}
+				writer.WriteLine (h.name + "_sum " + h.Sum.ToString ("0.###", culture));
+				writer.WriteLine (h.name + "_count " + h.Count);
+				writer.WriteLine (h.name + "_max " + h.Max.ToString ("0.###", culture));
+			}
+
+			PoolStats[] pools = PoolStats.All;
+			writer.WriteLine ("# TYPE astar_pool_depot_size gauge");
+			for (int i=0;i<pools.Length;i++) writer.WriteLine ("astar_pool_depot_size{pool=\"" + pools[i].name + "\"} " + pools[i].depotSize);
+			writer.WriteLine ("# TYPE astar_pool_hit_rate gauge");
+			for (int i=0;i<pools.Length;i++) writer.WriteLine ("astar_pool_hit_rate{pool=\"" + pools[i].name + "\"} " + pools[i].HitRate.ToString ("0.###", culture));
+			writer.WriteLine ("# TYPE astar_pool_contention counter");
+			for (int i=0;i<pools.Length;i++) writer.WriteLine ("astar_pool_contention{pool=\"" + pools[i].name + "\"} " + pools[i].contention);
+
+			writer.WriteLine ("# TYPE astar_path_pool_size gauge");
+			writer.WriteLine ("astar_path_pool_size{type=\"ABPath\"} " + PathPool<ABPath>.GetSize ());
+			writer.WriteLine ("# TYPE astar_path_pool_created counter");
+			writer.WriteLine ("astar_path_pool_created{type=\"ABPath\"} " + PathPool<ABPath>.GetTotalCreated ());
+
+			writer.WriteLine ("# TYPE astar_gc_heap_bytes gauge");
+			writer.WriteLine ("astar_gc_heap_bytes " + GC.GetTotalMemory (false));
+			writer.WriteLine ("# TYPE astar_gc_collections counter");
+			for (int g=0;g<=GC.MaxGeneration;g++) writer.WriteLine ("astar_gc_collections{generation=\"" + g + "\"} " + GC.CollectionCount (g));
+		}
+	}
+}
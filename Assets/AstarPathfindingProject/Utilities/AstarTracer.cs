@@ -0,0 +1,174 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using System.Threading;
+using Stopwatch = System.Diagnostics.Stopwatch;
+
+namespace Pathfinding {
+	/** Low overhead tracer of the pathfinding threads, exported as Chrome trace events.
+	 * Unlike AstarProfiler it is always compiled and safe to use from any thread.
+	 *
+	 * Event names are interned once with Register, usually in a static readonly field:
+	 * \code
+	 * static readonly int SearchEvent = AstarTracer.Register ("Search");
+	 * ...
+	 * AstarTracer.Begin (SearchEvent);
+	 * p.CalculateStep (targetTick);
+	 * AstarTracer.End (SearchEvent);
+	 * \endcode
+	 *
+	 * Every thread writes begin/end records to its own ring buffer, without locking. When a buffer is full
+	 * the oldest records are overwritten, so a trace holds the last #BufferSize records of every thread.
+	 * When #enabled is false Begin and End only read a static field.
+	 *
+	 * The trace is written with WriteChromeTrace and can be opened in chrome://tracing or Perfetto.
+	 * Tracing can be turned on from the command line with -astarTrace \<file\>, the trace is then written
+	 * to the file when AstarPath is destroyed.
+	 *
+	 * \see AstarProfiler
+	 */
+	public static class AstarTracer {
+
+		/** Records per thread */
+		public const int BufferSize = 1 << 16;
+
+		/** Records are only written while this is true */
+		public static volatile bool enabled;
+
+		/** File the trace is written to when AstarPath is destroyed, set by the -astarTrace argument */
+		public static string exportPath;
+
+		class ThreadBuffer {
+			public readonly long[] ticks = new long[BufferSize];
+			public readonly int[] events = new int[BufferSize];	/**< Event id for begin records, ~id for end records */
+			public long written;
+			public int threadId;
+			public string threadName;
+		}
+
+		[ThreadStatic]
+		static ThreadBuffer local;
+
+		static readonly List<ThreadBuffer> buffers = new List<ThreadBuffer> ();
+		static readonly List<string> names = new List<string> ();
+		static readonly long startTicks = Stopwatch.GetTimestamp ();
+
+		/** Id of the event \a name, the same name always gets the same id */
+		public static int Register (string name) {
+			lock (names) {
+				int id = names.IndexOf (name);
+				if (id != -1) return id;
+				names.Add (name);
+				return names.Count-1;
+			}
+		}
+
+		public static void Begin (int id) {
+			if (enabled) Write (id);
+		}
+
+		public static void End (int id) {
+			if (enabled) Write (~id);
+		}
+
+		static void Write (int record) {
+			ThreadBuffer b = local;
+			if (b == null) b = CreateBuffer ();
+
+			int i = (int)(b.written & (BufferSize-1));
+			b.ticks[i] = Stopwatch.GetTimestamp ();
+			b.events[i] = record;
+			b.written++;
+		}
+
+		static ThreadBuffer CreateBuffer () {
+			ThreadBuffer b = new ThreadBuffer ();
+			Thread thread = Thread.CurrentThread;
+			b.threadId = thread.ManagedThreadId;
+			b.threadName = thread.Name ?? "Thread " + b.threadId;
+			lock (buffers) {
+				buffers.Add (b);
+			}
+			local = b;
+			return b;
+		}
+
+		/** Enables tracing if the -astarTrace \<file\> argument is given, called by AstarPath.Awake */
+		public static void ReadCommandLine () {
+			string[] args = Environment.GetCommandLineArgs ();
+			for (int i=0;i<args.Length-1;i++) {
+				if (args[i] == "-astarTrace") {
+					exportPath = args[i+1];
+					enabled = true;
+				}
+			}
+		}
+
+		/** Discards the records of all threads.
+		 * Should not be called while other threads are tracing, their next records may be lost.
+		 */
+		public static void Clear () {
+			lock (buffers) {
+				for (int i=0;i<buffers.Count;i++) buffers[i].written = 0;
+			}
+		}
+
+		/** Writes the records of all threads in the Chrome trace event format.
+		 * Threads can keep tracing while this runs, records written meanwhile may be missing or out of order.
+		 * End records whose begin record was overwritten are skipped.
+		 */
+		public static void WriteChromeTrace (string path) {
+			string[] eventNames;
+			lock (names) {
+				eventNames = names.ToArray ();
+			}
+
+			ThreadBuffer[] threads;
+			lock (buffers) {
+				threads = buffers.ToArray ();
+			}
+
+			double toMicroseconds = 1000000.0 / Stopwatch.Frequency;
+			var culture = System.Globalization.CultureInfo.InvariantCulture;
+
+			using (var writer = new StreamWriter (path, false, new UTF8Encoding (false))) {
+				writer.Write ("{\"traceEvents\":[\n");
+				bool first = true;
+
+				for (int t=0;t<threads.Length;t++) {
+					ThreadBuffer b = threads[t];
+					if (!first) writer.Write (",\n");
+					first = false;
+					writer.Write ("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + b.threadId +
+						",\"args\":{\"name\":\"" + Escape (b.threadName) + "\"}}");
+
+					long written = b.written;
+					long start = Math.Max (0, written-BufferSize);
+					int depth = 0;
+					for (long r=start;r<written;r++) {
+						int i = (int)(r & (BufferSize-1));
+						int record = b.events[i];
+						bool begin = record >= 0;
+						int id = begin ? record : ~record;
+						if (id >= eventNames.Length) continue;
+
+						if (begin) depth++;
+						else if (depth == 0) continue;
+						else depth--;
+
+						double ts = (b.ticks[i]-startTicks)*toMicroseconds;
+						writer.Write (",\n{\"name\":\"" + Escape (eventNames[id]) + "\",\"ph\":\"" + (begin ? "B" : "E") +
+							"\",\"pid\":1,\"tid\":" + b.threadId + ",\"ts\":" + ts.ToString ("0.000", culture) + "}");
+					}
+				}
+
+				writer.Write ("\n],\"displayTimeUnit\":\"ms\"}\n");
+			}
+		}
+
+		static string Escape (string s) {
+			return s.Replace ("\\", "\\\\").Replace ("\"", "\\\"");
+		}
+	}
+}
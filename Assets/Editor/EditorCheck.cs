@@ -0,0 +1,43 @@
+using UnityEngine;
+using UnityEditor;
+using UnityEditorInternal;
+
+/**
+* Assertions of the headless checks of the game systems (eg: VisibilityCheck).
+*
+* Unity -batchmode -projectPath . -executeMethod VisibilityCheck.Run
+*
+* Every failed assertion is logged as an error. In batch mode Finish quits the editor with exit code 1
+* if an assertion failed and 0 otherwise, so the checks can run in CI without a player build.
+*/
+public class EditorCheck {
+
+	private readonly string name;
+	private int failures = 0;
+	private int checks = 0;
+
+	public EditorCheck(string name){
+		this.name = name;
+	}
+
+	public void Assert(bool condition, string message){
+		checks++;
+		if (condition) return;
+		failures++;
+		Debug.LogError(name + ": " + message);
+	}
+
+	public bool Failed {
+		get { return failures > 0; }
+	}
+
+	/**
+	* Log the result, and exit when running in batch mode
+	*/
+	public void Finish(){
+		if (failures == 0) Debug.Log (name + ": " + checks + " checks passed");
+		else Debug.LogError(name + ": " + failures + " of " + checks + " checks failed");
+
+		if (InternalEditorUtility.inBatchMode) EditorApplication.Exit(failures == 0 ? 0 : 1);
+	}
+}
@@ -0,0 +1,101 @@
+using UnityEngine;
+using UnityEditor;
+
+/**
+* Headless check of the minimap rasterizer, see MinimapRaster.
+*
+* Unity -batchmode -projectPath . -executeMethod MinimapRasterCheck.Run
+*
+* Rasterizes a small ramp heightfield (height = x) with fog over half of the map and two dots, one of them clipped
+* by the corner, and checks the pixel colors and the mapping from minimap clicks to world positions.
+*/
+public class MinimapRasterCheck {
+
+	private const int PIXELS = 16;
+	private static readonly Rect AREA = new Rect(100, 200, 32, 32); //2 world units per pixel
+
+	//MinimapRaster terrain colors, lowest and highest point
+	private static readonly Color32 LOW = new Color32(52, 84, 38, 255);
+	private static readonly Color32 HIGH = new Color32(150, 132, 92, 255);
+	private static readonly Color32 DOT = new Color32(255, 0, 0, 255);
+
+	[MenuItem("Tools/Checks/Minimap Raster")]
+	public static void Run(){
+		EditorCheck check = new EditorCheck("MinimapRaster");
+		MinimapRaster raster = new MinimapRaster(PIXELS, PIXELS, AREA, delegate (float x, float z) { return x; });
+		Color32[] pixels = new Color32[PIXELS * PIXELS];
+
+		//Terrain only
+		raster.Render(pixels, new MinimapRaster.Dot[0], 0, null, 0, 0, 1);
+		check.Assert(Same(pixels[0], LOW), "lowest column is not the low color " + pixels[0]);
+		check.Assert(Same(pixels[PIXELS - 1], HIGH), "highest column is not the high color " + pixels[PIXELS - 1]);
+		bool rising = true, flat = true;
+		for (int y = 0; y < PIXELS; y++) {
+			for (int x = 0; x < PIXELS; x++) {
+				Color32 c = pixels[y * PIXELS + x];
+				if (x > 0 && c.r < pixels[y * PIXELS + x - 1].r) rising = false;
+				if (!Same(c, pixels[x])) flat = false;
+			}
+		}
+		check.Assert(rising, "terrain color doesn't rise with the height");
+		check.Assert(flat, "terrain color changes along z on a ramp along x");
+
+		//Fog: cells of 1 world unit, only the west half visible
+		int fogWidth = (int) AREA.width, fogDepth = (int) AREA.height;
+		uint[] fog = new uint[(fogWidth * fogDepth + 31) / 32];
+		for (int z = 0; z < fogDepth; z++) {
+			for (int x = 0; x < fogWidth / 2; x++) {
+				int cell = z * fogWidth + x;
+				fog[cell >> 5] |= 1u << (cell & 31);
+			}
+		}
+		MinimapRaster.Dot[] dots = new MinimapRaster.Dot[2];
+		dots[0] = Dot(AREA.xMin + 10, AREA.yMin + 20, 2); //Pixels 4..5, 9..10
+		dots[1] = Dot(AREA.xMin, AREA.yMin, 4); //Clipped by the corner, pixels 0..1
+		raster.Render(pixels, dots, dots.Length, fog, fogWidth, fogDepth, 1);
+
+		Color32 seen = pixels[3 * PIXELS + 3];
+		Color32 hidden = pixels[3 * PIXELS + PIXELS - 1];
+		check.Assert(Same(seen, Lerp(3)), "visible pixel is dimmed " + seen);
+		check.Assert(Same(hidden, Dimmed(HIGH)), "hidden pixel is not dimmed " + hidden);
+
+		check.Assert(Same(pixels[9 * PIXELS + 4], DOT) && Same(pixels[10 * PIXELS + 5], DOT), "dot not drawn at its pixels");
+		check.Assert(!Same(pixels[11 * PIXELS + 5], DOT) && !Same(pixels[10 * PIXELS + 6], DOT), "dot bigger than its size");
+		check.Assert(Same(pixels[0], DOT) && Same(pixels[PIXELS + 1], DOT), "dot clipped by the corner not drawn");
+		check.Assert(!Same(pixels[2 * PIXELS + 2], DOT), "clipped dot drawn outside of the map");
+
+		//Clicks
+		Vector2 center = raster.NormalizedToWorld(new Vector2(0.5f, 0.5f));
+		check.Assert(center == AREA.center, "center of the minimap is " + center + ", not " + AREA.center);
+		Vector2 corner = raster.NormalizedToWorld(new Vector2(1, 0));
+		check.Assert(corner == new Vector2(AREA.xMax, AREA.yMin), "bottom right corner of the minimap is " + corner);
+		Vector2 dot = raster.PixelToWorld(4.5f, 9.5f);
+		check.Assert(Mathf.Abs(dot.x - dots[0].x) <= 2 && Mathf.Abs(dot.y - dots[0].z) <= 2, "pixel of the dot maps to " + dot);
+
+		check.Finish();
+	}
+
+	private static MinimapRaster.Dot Dot(float x, float z, int size){
+		MinimapRaster.Dot dot = new MinimapRaster.Dot();
+		dot.x = x;
+		dot.z = z;
+		dot.size = size;
+		dot.color = DOT;
+		return dot;
+	}
+
+	/**
+	* Terrain color of a column of the ramp
+	*/
+	private static Color32 Lerp(int column){
+		return Color32.Lerp(LOW, HIGH, (float) column / (PIXELS - 1));
+	}
+
+	private static Color32 Dimmed(Color32 c){
+		return new Color32((byte) (c.r >> 2), (byte) (c.g >> 2), (byte) (c.b >> 2), c.a);
+	}
+
+	private static bool Same(Color32 a, Color32 b){
+		return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+	}
+}
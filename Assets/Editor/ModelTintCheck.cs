@@ -0,0 +1,80 @@
+using UnityEngine;
+using UnityEditor;
+
+/**
+* Headless check of the model colors, see ModelTint.
+*
+* Unity -batchmode -projectPath . -executeMethod ModelTintCheck.Run
+*
+* Tints a model of two renderers every frame like the game does (team colors, placement ghost, selection life)
+* and checks that property blocks are only applied when the color changes (ModelTint.applied), that no material is
+* created, and that setting only the alpha keeps the base color of each renderer.
+*/
+public class ModelTintCheck {
+
+	private const int FRAMES = 100;
+	private const int CHANGE_EVERY = 10;
+
+	[MenuItem("Tools/Checks/Model Tint")]
+	public static void Run(){
+		EditorCheck check = new EditorCheck("ModelTint");
+		int color = Shader.PropertyToID("_Color");
+
+		Shader shader = Shader.Find("Diffuse");
+		Material red = new Material(shader);
+		red.color = Color.red;
+		Material blue = new Material(shader);
+		blue.color = Color.blue;
+		GameObject model = Model(red, blue);
+
+		try {
+			Renderer[] renderers = model.GetComponentsInChildren<Renderer>();
+			int materials = Resources.FindObjectsOfTypeAll<Material>().Length;
+
+			//Alpha only, each renderer keeps its base color
+			ModelTint faded = new ModelTint(renderers);
+			int applied = ModelTint.applied;
+			for (int frame = 0; frame < FRAMES; frame++) faded.SetAlpha(0.5f);
+			check.Assert(ModelTint.applied - applied == 1, "same alpha applied " + (ModelTint.applied - applied) + " times");
+
+			MaterialPropertyBlock block = new MaterialPropertyBlock();
+			renderers[0].GetPropertyBlock(block);
+			check.Assert(block.GetVector(color) == (Vector4) new Color(1, 0, 0, 0.5f), "first renderer lost its base color");
+			renderers[1].GetPropertyBlock(block);
+			check.Assert(block.GetVector(color) == (Vector4) new Color(0, 0, 1, 0.5f), "second renderer lost its base color");
+
+			//A color every frame, changing every CHANGE_EVERY frames
+			ModelTint tint = new ModelTint(renderers);
+			applied = ModelTint.applied;
+			for (int frame = 0; frame < FRAMES; frame++) {
+				tint.Set((frame / CHANGE_EVERY) % 2 == 0 ? Color.green : Color.yellow);
+				tint.SetAlpha(1);
+			}
+			int expected = FRAMES / CHANGE_EVERY;
+			check.Assert(ModelTint.applied - applied == expected, "colors applied " + (ModelTint.applied - applied) + " times, " + expected + " changes");
+
+			check.Assert(Resources.FindObjectsOfTypeAll<Material>().Length == materials, "materials created while tinting");
+			check.Assert(renderers[0].sharedMaterial == red && renderers[1].sharedMaterial == blue, "shared materials replaced");
+		} finally {
+			Object.DestroyImmediate(model);
+			Object.DestroyImmediate(red);
+			Object.DestroyImmediate(blue);
+		}
+		check.Finish();
+	}
+
+	/**
+	* Model with a child renderer per material, like the models of the units
+	*/
+	private static GameObject Model(params Material[] materials){
+		GameObject model = new GameObject("ModelTintCheck model");
+		model.hideFlags = HideFlags.HideAndDontSave;
+		foreach (Material m in materials) {
+			GameObject part = GameObject.CreatePrimitive(PrimitiveType.Cube);
+			part.hideFlags = HideFlags.HideAndDontSave;
+			part.transform.parent = model.transform;
+			part.GetComponent<Renderer>().sharedMaterial = m;
+		}
+		return model;
+	}
+}
@@ -0,0 +1,331 @@
+using UnityEngine;
+using UnityEditor;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System.Threading;
+using System;
+using Pathfinding;
+using Path = System.IO.Path;
+using Stopwatch = System.Diagnostics.Stopwatch;
+
+/**
+* Offline pathfinding benchmark over the heightmaps of Assets/maps.
+*
+* Unity -batchmode -quit -projectPath . -executeMethod PathfindingBenchmark.Run
+*     [-pathBenchmarkMaps LostTemple1v1,Tundra] [-pathBenchmarkThreads 1,2,4] [-pathBenchmarkQueries 500]
+*     [-pathBenchmarkOut pathfinding-benchmark.csv]
+*
+* Every map is loaded into a copy of the terrain of the game scene and the GridGraph of the scene is scanned
+* over it, so the graph has the game's node size, slope and collision settings.
+* Three query sets are generated with a fixed seed (short, medium and cross map, by distance relative to the map size),
+* between walkable nodes of the same area so every query has a path.
+*
+* Every set is searched with each thread count. The searches run on threads of the benchmark with a PathHandler each,
+* like the path threads of AstarPath (which only runs one of them in this version).
+* Results: paths/sec, p50/p99 latency, nodes expanded and GC memory, per map, query set and thread count.
+*/
+public class PathfindingBenchmark {
+
+	private const string SCENE = "Assets/game.unity";
+	private const string MAPS = "Assets/maps";
+	private const int SEED = 1234;
+	private const int WARMUP_QUERIES = 20;
+	private const int MAX_TRIES = 100; //Per query, before giving up on a start node
+
+	private class QuerySet {
+		public string name;
+		public float min, max; //Distance, as a fraction of the map size
+		public QuerySet(string name, float min, float max){
+			this.name = name;
+			this.min = min;
+			this.max = max;
+		}
+	}
+
+	private static readonly QuerySet[] SETS = {
+		new QuerySet("short", 0.02f, 0.1f),
+		new QuerySet("medium", 0.15f, 0.35f),
+		new QuerySet("cross", 0.6f, 1.2f)
+	};
+
+	private class Result {
+		public string map;
+		public int nodes, walkable;
+		public string set;
+		public int threads;
+		public int paths, failed;
+		public float seconds;
+		public float p50, p99; //ms
+		public float nodesExpanded; //Per path
+		public float allocated; //KB
+		public int collections;
+	}
+
+	private static List<Result> results = new List<Result>();
+
+	[MenuItem("Tools/Pathfinding Benchmark")]
+	public static void Run(){
+		string[] maps = null;
+		int[] threads = { 1, 2, 4 };
+		int queries = 500;
+		string output = "pathfinding-benchmark.csv";
+
+		string[] args = Environment.GetCommandLineArgs();
+		for (int i = 0; i < args.Length - 1; i++) {
+			if (args[i] == "-pathBenchmarkMaps") maps = args[i+1].Split(',');
+			else if (args[i] == "-pathBenchmarkThreads") threads = Array.ConvertAll(args[i+1].Split(','), s => int.Parse(s));
+			else if (args[i] == "-pathBenchmarkQueries") queries = int.Parse(args[i+1]);
+			else if (args[i] == "-pathBenchmarkOut") output = args[i+1];
+		}
+
+		if (!Application.isPlaying && EditorApplication.currentScene != SCENE) {
+			if (!EditorApplication.SaveCurrentSceneIfUserWantsTo()) return;
+			EditorApplication.OpenScene(SCENE);
+		}
+
+		AstarPath astar = UnityEngine.Object.FindObjectOfType<AstarPath>();
+		Terrain terrain = UnityEngine.Object.FindObjectOfType<Terrain>();
+		AstarPath.active = astar;
+		if (astar.astarData.graphs == null) astar.astarData.DeserializeGraphs();
+
+		TerrainData original = terrain.terrainData;
+		TerrainCollider collider = terrain.GetComponent<TerrainCollider>();
+		results.Clear();
+		try {
+			foreach (string file in Directory.GetFiles(MAPS)) {
+				string name = MapName(file);
+				if (name == null || (maps != null && Array.IndexOf(maps, name) < 0)) continue;
+
+				TerrainData data = (TerrainData) UnityEngine.Object.Instantiate(original); //The scene terrain is not modified
+				if (!LoadHeights(file, data)) continue;
+				terrain.terrainData = data;
+				if (collider != null) collider.terrainData = data;
+				RunMap(name, astar, threads, queries);
+			}
+		} finally {
+			terrain.terrainData = original;
+			if (collider != null) collider.terrainData = original;
+			EditorUtility.ClearProgressBar();
+		}
+
+		WriteCsv(output);
+		Debug.Log ("Pathfinding benchmark written to " + output);
+	}
+
+	// ------------------------------------
+	// MAPS
+	// ------------------------------------
+
+	/**
+	* Name of the map of a heightmap file, null if it isn't one
+	*/
+	private static string MapName(string file){
+		string extension = Path.GetExtension(file).ToLower();
+		if (extension != ".jpg" && extension != ".png" && extension != ".raw") return null;
+		string name = Path.GetFileNameWithoutExtension(file);
+		return name.EndsWith(".heightmap") ? Path.GetFileNameWithoutExtension(name) : name;
+	}
+
+	/**
+	* Resample the heightmap to the resolution of data.
+	* Images use their grayscale, raw files are square 16 bits little endian
+	*/
+	private static bool LoadHeights(string file, TerrainData data){
+		int resolution = data.heightmapResolution;
+		float[,] heights = new float[resolution, resolution];
+		byte[] bytes = File.ReadAllBytes(file);
+
+		if (Path.GetExtension(file).ToLower() == ".raw") {
+			int size = (int) Mathf.Sqrt(bytes.Length / 2);
+			if (size * size * 2 != bytes.Length) {
+				Debug.LogWarning ("Skipping " + file + ": not a square 16 bits heightmap");
+				return false;
+			}
+			for (int z = 0; z < resolution; z++) {
+				for (int x = 0; x < resolution; x++) {
+					int i = Mathf.RoundToInt((float) z / (resolution - 1) * (size - 1)) * size + Mathf.RoundToInt((float) x / (resolution - 1) * (size - 1));
+					heights[z, x] = (bytes[2 * i] | bytes[2 * i + 1] << 8) / 65535f;
+				}
+			}
+		} else {
+			Texture2D texture = new Texture2D(2, 2);
+			if (!texture.LoadImage(bytes)) {
+				Debug.LogWarning ("Skipping " + file + ": unreadable image");
+				return false;
+			}
+			for (int z = 0; z < resolution; z++) {
+				for (int x = 0; x < resolution; x++) {
+					heights[z, x] = texture.GetPixelBilinear((float) x / (resolution - 1), (float) z / (resolution - 1)).grayscale;
+				}
+			}
+			UnityEngine.Object.DestroyImmediate(texture);
+		}
+		data.SetHeights(0, 0, heights);
+		return true;
+	}
+
+	private static void RunMap(string name, AstarPath astar, int[] threads, int queries){
+		EditorUtility.DisplayProgressBar("Pathfinding Benchmark", "Scanning " + name, 0);
+		astar.Scan();
+		GridGraph graph = astar.astarData.gridGraph;
+
+		int walkable = 0;
+		foreach (GridNode node in graph.nodes) if (node != null && node.Walkable) walkable++;
+		Debug.Log ("Map " + name + ": " + graph.width + "x" + graph.depth + " nodes, " + walkable + " walkable");
+		if (walkable == 0) return;
+
+		//A handler per thread, like AstarPath.threadInfos
+		int maxThreads = Mathf.Max(threads);
+		PathHandler[] handlers = new PathHandler[maxThreads];
+		for (int t = 0; t < maxThreads; t++) {
+			PathHandler handler = new PathHandler();
+			graph.GetNodes(node => { handler.InitializeNode(node); return true; });
+			handlers[t] = handler;
+		}
+
+		System.Random random = new System.Random(SEED);
+		foreach (QuerySet set in SETS) {
+			List<GridNode[]> pairs = Queries(graph, set, queries, random);
+			if (pairs.Count < queries) Debug.LogWarning (name + " " + set.name + ": only " + pairs.Count + " queries found");
+			if (pairs.Count == 0) continue;
+
+			Search(Construct(pairs.GetRange(0, Mathf.Min(WARMUP_QUERIES, pairs.Count))), handlers, 1, new float[pairs.Count]); //JIT and caches
+
+			foreach (int count in threads) {
+				EditorUtility.DisplayProgressBar("Pathfinding Benchmark", name + " " + set.name + ", " + count + " threads", 0.5f);
+				Result r = Measure(pairs, handlers, count);
+				r.map = name;
+				r.nodes = graph.nodes.Length;
+				r.walkable = walkable;
+				r.set = set.name;
+				results.Add(r);
+				Debug.Log (name + " " + set.name + " x" + count + ": " + Format(r.paths / r.seconds) + " paths/s, p50 " +
+					Format(r.p50) + " ms, p99 " + Format(r.p99) + " ms, " + Format(r.nodesExpanded) + " nodes/path");
+			}
+		}
+	}
+
+	/**
+	* Pairs of walkable nodes of the same area, at a distance in [set.min, set.max] of the map size
+	*/
+	private static List<GridNode[]> Queries(GridGraph graph, QuerySet set, int count, System.Random random){
+		List<GridNode[]> pairs = new List<GridNode[]>();
+		int size = Mathf.Max(graph.width, graph.depth);
+		int tries = 0;
+		while (pairs.Count < count && tries < count * MAX_TRIES) {
+			tries++;
+			GridNode start = graph.nodes[random.Next(graph.nodes.Length)];
+			if (start == null || !start.Walkable) continue;
+
+			double angle = random.NextDouble() * 2 * Math.PI;
+			double distance = (set.min + random.NextDouble() * (set.max - set.min)) * size;
+			int x = start.NodeInGridIndex % graph.width + (int) Math.Round(Math.Cos(angle) * distance);
+			int z = start.NodeInGridIndex / graph.width + (int) Math.Round(Math.Sin(angle) * distance);
+			if (x < 0 || z < 0 || x >= graph.width || z >= graph.depth) continue;
+
+			GridNode end = graph.nodes[z * graph.width + x];
+			if (end == null || !end.Walkable || end.Area != start.Area || end == start) continue;
+			pairs.Add(new GridNode[]{ start, end });
+		}
+		return pairs;
+	}
+
+	// ------------------------------------
+	// SEARCH
+	// ------------------------------------
+
+	private static Result Measure(List<GridNode[]> pairs, PathHandler[] handlers, int threads){
+		float[] latencies = new float[pairs.Count];
+		ABPath[] paths = Construct(pairs);
+		long memory = GC.GetTotalMemory(true);
+		int collections = GC.CollectionCount(0);
+		long start = Stopwatch.GetTimestamp();
+
+		Search(paths, handlers, threads, latencies);
+
+		Result r = new Result();
+		r.seconds = (float) ((Stopwatch.GetTimestamp() - start) / (double) Stopwatch.Frequency);
+		r.allocated = (GC.GetTotalMemory(false) - memory) / 1024f;
+		r.collections = GC.CollectionCount(0) - collections;
+		r.threads = threads;
+		r.paths = paths.Length;
+
+		long expanded = 0;
+		foreach (ABPath p in paths) {
+			expanded += p.searchedNodes;
+			if (p.CompleteState != PathCompleteState.Complete) r.failed++;
+		}
+		r.nodesExpanded = (float) expanded / paths.Length;
+
+		Array.Sort(latencies);
+		r.p50 = latencies[Mathf.Min(latencies.Length - 1, (int) (0.5f * latencies.Length))];
+		r.p99 = latencies[Mathf.Min(latencies.Length - 1, (int) (0.99f * latencies.Length))];
+		return r;
+	}
+
+	/**
+	* Paths are created on the main thread, Path.Reset needs AstarPath.active
+	*/
+	private static ABPath[] Construct(List<GridNode[]> pairs){
+		ABPath[] paths = new ABPath[pairs.Count];
+		for (int i = 0; i < paths.Length; i++) paths[i] = ABPath.Construct((Vector3) pairs[i][0].position, (Vector3) pairs[i][1].position);
+		return paths;
+	}
+
+	/**
+	* Search the paths with threads threads, latencies[i] is set to the ms of path i
+	*/
+	private static void Search(ABPath[] paths, PathHandler[] handlers, int threads, float[] latencies){
+		int next = -1;
+		Thread[] workers = new Thread[threads];
+		for (int t = 0; t < threads; t++) {
+			PathHandler handler = handlers[t];
+			workers[t] = new Thread(() => {
+				int i;
+				while ((i = Interlocked.Increment(ref next)) < paths.Length) {
+					long start = Stopwatch.GetTimestamp();
+					Calculate(paths[i], handler);
+					latencies[i] = (float) ((Stopwatch.GetTimestamp() - start) * 1000.0 / Stopwatch.Frequency);
+				}
+			});
+			workers[t].Start();
+		}
+		foreach (Thread worker in workers) worker.Join();
+	}
+
+	/**
+	* The steps of AstarPath.CalculatePathsThreaded for a single path, without the callbacks
+	*/
+	private static void Calculate(ABPath p, PathHandler handler){
+		p.PrepareBase(handler);
+		p.AdvanceState(PathState.Processing);
+		p.Prepare();
+		if (!p.IsDone()) {
+			p.Initialize();
+			while (!p.IsDone()) p.CalculateStep(long.MaxValue);
+		}
+		p.Cleanup();
+	}
+
+	// ------------------------------------
+	// OUTPUT
+	// ------------------------------------
+
+	private static void WriteCsv(string path){
+		StringBuilder csv = new StringBuilder();
+		csv.Append("map,nodes,walkable,queries,threads,paths,failed,seconds,paths_per_sec,p50_ms,p99_ms,nodes_expanded,allocated_kb,gc_collections\n");
+		foreach (Result r in results) {
+			csv.Append(r.map).Append(',').Append(r.nodes).Append(',').Append(r.walkable).Append(',').Append(r.set);
+			csv.Append(',').Append(r.threads).Append(',').Append(r.paths).Append(',').Append(r.failed);
+			foreach (float f in new float[]{ r.seconds, r.paths / r.seconds, r.p50, r.p99, r.nodesExpanded, r.allocated }) csv.Append(',').Append(Format(f));
+			csv.Append(',').Append(r.collections).Append('\n');
+		}
+		File.WriteAllText(path, csv.ToString());
+	}
+
+	private static string Format(float f){
+		return f.ToString("0.###", CultureInfo.InvariantCulture);
+	}
+}
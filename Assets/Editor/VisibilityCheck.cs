@@ -0,0 +1,113 @@
+using UnityEngine;
+using UnityEditor;
+using System.Collections.Generic;
+
+/**
+* Headless check of the fog of war grid, see Visibility.
+*
+* Unity -batchmode -projectPath . -executeMethod VisibilityCheck.Run
+*
+* Places viewers of two players on a grid without a scene, moves one of them and checks that only the bits
+* around its old and new cells changed, then removes another and checks that its cells are cleared.
+* Entities is reset before and after, the check must not run while a game is playing.
+*/
+public class VisibilityCheck {
+
+	private const int SIZE = 64;
+
+	[MenuItem("Tools/Checks/Visibility")]
+	public static void Run(){
+		EditorCheck check = new EditorCheck("Visibility");
+		if (Application.isPlaying) {
+			check.Assert(false, "stop the game before running the check");
+			check.Finish();
+			return;
+		}
+
+		List<GameObject> created = new List<GameObject>();
+		Entities.Reset();
+		try {
+			Visibility visibility = new Visibility(new Rect(0, 0, SIZE, SIZE));
+			Playable mover = Viewer(created, 0, new Vector3(10.5f, 0, 10.5f), 3);
+			Playable still = Viewer(created, 0, new Vector3(40.5f, 0, 40.5f), 3);
+			Viewer(created, 1, new Vector3(20.5f, 0, 50.5f), 4);
+
+			visibility.Tick();
+			Entities.ClearChanges();
+			check.Assert(visibility.updatedLastTick == 3, "3 viewers placed, " + visibility.updatedLastTick + " updated");
+			check.Assert(visibility.IsVisible(0, mover.transform.position), "cell of a viewer not visible");
+			check.Assert(!visibility.IsVisible(1, mover.transform.position), "cell visible to another player");
+
+			//Move one viewer
+			uint[] before0 = (uint[]) visibility.Bits(0).Clone();
+			uint[] before1 = (uint[]) visibility.Bits(1).Clone();
+			Vector3 from = mover.transform.position;
+			Vector3 to = new Vector3(17.5f, 0, 10.5f);
+			mover.transform.position = to;
+			Entities.MarkChanged(mover);
+			visibility.Tick();
+			Entities.ClearChanges();
+
+			check.Assert(visibility.updatedLastTick == 1, "1 viewer moved, " + visibility.updatedLastTick + " updated");
+			check.Assert(visibility.IsVisible(0, to), "new cell of the mover not visible");
+			check.Assert(!visibility.IsVisible(0, from), "old cell of the mover still visible");
+			check.Assert(visibility.IsVisible(0, still.transform.position), "cell of the other viewer lost");
+			check.Assert(Changed(before1, visibility.Bits(1)) == 0, "bits of the other player changed");
+
+			int outside = 0;
+			int changed = 0;
+			uint[] after0 = visibility.Bits(0);
+			for (int cell = 0; cell < visibility.width * visibility.depth; cell++) {
+				if (Bit(before0, cell) == Bit(after0, cell)) continue;
+				changed++;
+				Vector3 center = new Vector3(cell % visibility.width + 0.5f, 0, cell / visibility.width + 0.5f);
+				if (!Near(center, from, mover.sight) && !Near(center, to, mover.sight)) outside++;
+			}
+			check.Assert(changed > 0, "no bit changed after the move");
+			check.Assert(outside == 0, outside + " bits changed away from the mover");
+
+			//Remove the other viewer
+			Entities.Unregister(still.id);
+			visibility.Tick();
+			Entities.ClearChanges();
+			check.Assert(!visibility.IsVisible(0, still.transform.position), "cell of a removed viewer still visible");
+			check.Assert(visibility.IsVisible(0, to), "removing a viewer cleared the cells of another");
+		} finally {
+			foreach (GameObject go in created) Object.DestroyImmediate(go);
+			Entities.Reset();
+		}
+		check.Finish();
+	}
+
+	private static Playable Viewer(List<GameObject> created, int owner, Vector3 position, int sight){
+		GameObject go = new GameObject("VisibilityCheck viewer");
+		go.hideFlags = HideFlags.HideAndDontSave;
+		created.Add(go);
+		go.transform.position = position;
+
+		Playable p = go.AddComponent<Attacker>();
+		p.owner = owner;
+		p.sight = sight;
+		p.id = Entities.Register(p);
+		return p;
+	}
+
+	private static int Changed(uint[] a, uint[] b){
+		int changed = 0;
+		for (int i = 0; i < a.Length; i++) if (a[i] != b[i]) changed++;
+		return changed;
+	}
+
+	private static bool Bit(uint[] bits, int cell){
+		return (bits[cell >> 5] & (1u << (cell & 31))) != 0;
+	}
+
+	/**
+	* Inside the stencil of the sight, with a cell of margin for the rounding of the cells
+	*/
+	private static bool Near(Vector3 cell, Vector3 viewer, int sight){
+		float dx = cell.x - viewer.x;
+		float dz = cell.z - viewer.z;
+		return dx * dx + dz * dz <= (sight + 1) * (sight + 1);
+	}
+}
@@ -8,6 +8,7 @@ public class Attack {
 	public int damage = 0; //0 means no attack
 	public float speed = 0; //in seconds
 	public int range = 0;
+	public float projectileSpeed = 20; //World units per second when range > Projectiles.MELEE_RANGE, 0 hits instantly
 	
 	public AudioClip audio;
 }
@@ -0,0 +1,161 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Sound effects of the game, mixed once per frame instead of playing every event directly.
+*
+* Events are queued during the frame (attacks, deaths, unit responses, UI warnings), then:
+*  - sorted by priority, and by distance to the camera for the same priority,
+*  - culled if too far from the camera, the clip already played this frame or with too many voices of the clip,
+*  - played on a fixed pool of audio sources, stealing the source of a lower priority sound if all are busy.
+*/
+public class AudioEvents {
+
+	public const int PRIORITY_ATTACK = 0;
+	public const int PRIORITY_DEATH = 1;
+	public const int PRIORITY_VOICE = 2; //Unit responses
+	public const int PRIORITY_UI = 3;
+
+	public const int SOURCES = 16;
+	public const int MAX_PER_FRAME = 8;
+	public const int MAX_PER_CLIP = 3; //Voices of the same clip at the same time
+	public const float MAX_DISTANCE = 60; //From the camera
+
+	private struct AudioEvent {
+		public AudioClip clip;
+		public Vector3 position;
+		public bool positional;
+		public int priority;
+		public float distance;
+	}
+
+	private static List<AudioEvent> events = new List<AudioEvent>();
+	private static System.Comparison<AudioEvent> compare = Compare; //Cached, Sort(Compare) allocates a delegate
+	private static HashSet<AudioClip> played = new HashSet<AudioClip>(); //Clips played in this flush
+	private static AudioSource[] sources;
+	private static int[] priorities = new int[SOURCES]; //Priority of the sound playing in every source
+
+	public static int culledLastFrame; //Events not played in the last frame
+
+	// ------------------------------------
+	// EVENTS
+	// ------------------------------------
+
+	/**
+	* Sound at a position of the map
+	*/
+	public static void Play(AudioClip clip, Vector3 position, int priority){
+		Queue(clip, position, true, priority);
+	}
+
+	/**
+	* Sound not attached to the map (eg: UI warnings)
+	*/
+	public static void Play2D(AudioClip clip, int priority){
+		Queue(clip, Vector3.zero, false, priority);
+	}
+
+	private static void Queue(AudioClip clip, Vector3 position, bool positional, int priority){
+		if (clip == null) return;
+		AudioEvent e = new AudioEvent();
+		e.clip = clip;
+		e.position = position;
+		e.positional = positional;
+		e.priority = priority;
+		events.Add(e);
+	}
+
+	// ------------------------------------
+	// MIX
+	// ------------------------------------
+
+	/**
+	* Play the events of the frame, call once per frame after the simulation
+	*/
+	public static void Flush(){
+		culledLastFrame = 0;
+		if (events.Count == 0) return;
+		if (sources == null || sources[0] == null) CreatePool();
+
+		Camera camera = Camera.main;
+		Vector3 listener = camera != null ? camera.transform.position : Vector3.zero;
+		for (int i = 0; i < events.Count; i++) {
+			AudioEvent e = events[i];
+			e.distance = e.positional ? (e.position - listener).magnitude : 0;
+			events[i] = e;
+		}
+		events.Sort(compare);
+
+		played.Clear();
+		for (int i = 0; i < events.Count; i++) {
+			AudioEvent e = events[i];
+			if (played.Count >= MAX_PER_FRAME || e.distance > MAX_DISTANCE || played.Contains(e.clip) || Voices(e.clip) >= MAX_PER_CLIP) {
+				culledLastFrame++;
+				continue;
+			}
+
+			int source = FreeSource(e.priority);
+			if (source < 0) {
+				culledLastFrame++;
+				continue;
+			}
+			PlayOn(source, e);
+			played.Add(e.clip);
+		}
+		events.Clear();
+	}
+
+	private static int Compare(AudioEvent a, AudioEvent b){
+		if (a.priority != b.priority) return b.priority.CompareTo(a.priority);
+		return a.distance.CompareTo(b.distance);
+	}
+
+	private static int Voices(AudioClip clip){
+		int voices = 0;
+		foreach (AudioSource s in sources) if (s.isPlaying && s.clip == clip) voices++;
+		return voices;
+	}
+
+	/**
+	* Idle source, or the source of the lowest priority sound below priority. -1 if none
+	*/
+	private static int FreeSource(int priority){
+		int lowest = -1;
+		for (int i = 0; i < sources.Length; i++) {
+			if (!sources[i].isPlaying) return i;
+			if (priorities[i] < priority && (lowest < 0 || priorities[i] < priorities[lowest])) lowest = i;
+		}
+		return lowest;
+	}
+
+	private static void PlayOn(int index, AudioEvent e){
+		AudioSource source = sources[index];
+		source.Stop();
+		source.clip = e.clip;
+		source.spatialBlend = e.positional ? 1 : 0;
+		source.transform.position = e.position;
+		source.Play();
+		priorities[index] = e.priority;
+	}
+
+	private static void CreatePool(){
+		GameObject pool = new GameObject("AudioPool");
+		sources = new AudioSource[SOURCES];
+		for (int i = 0; i < SOURCES; i++) {
+			GameObject go = new GameObject("AudioSource" + i);
+			go.transform.parent = pool.transform;
+			AudioSource source = go.AddComponent<AudioSource>();
+			source.playOnAwake = false;
+			source.minDistance = 10; //Audible from the camera height
+			sources[i] = source;
+		}
+	}
+
+	/**
+	* Called when the level is unloaded, the pool is destroyed with it
+	*/
+	public static void Reset(){
+		events.Clear();
+		sources = null;
+	}
+}
@@ -0,0 +1,381 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Text;
+using System;
+using Pathfinding;
+using Stopwatch = System.Diagnostics.Stopwatch;
+
+/**
+* Survival stress benchmark: scripted waves of increasing size, measured at a fixed timestep.
+*
+* game -batchmode -nographics -benchmark 100,250,500,1000,2500,5000 [-benchmarkSeconds 20] [-benchmarkOut results]
+*
+* Every wave starts from the same state (the game after loading, or the -snapshot file, see Snapshot):
+* half of the units are rush enemies attacking player1, the other half defend the main base.
+* A wave is measured until the time is over or one of the sides is dead, then the scaling curve
+* (frame times and per phase timings for every wave size) is written to results.csv and results.json.
+*
+* Phases: AI (Playable.Ai, the computer player planner and the influence and visibility grids), movement (path following and Crowd), combat (attacks and Combat),
+* path queue wait and path compute (measured on the path threads) and GC allocations.
+*/
+public class Benchmark {
+
+	public const int AI = 0;
+	public const int MOVEMENT = 1;
+	public const int COMBAT = 2;
+	private const int PHASES = 3;
+	private static readonly string[] PHASE_NAMES = { "ai", "movement", "combat" };
+
+	private const int SEED = 1234;
+	private const int SETUP_FRAMES = 10; //Before saving the initial state, so everything has started
+	private const int SPAWN_PER_FRAME = 100;
+	private const int WARMUP_FRAMES = 30;
+	private const float SPREAD = 1.5f; //Between spawned units
+
+	private static readonly string[] DEFENDERS = { "Marine", "Firebat" };
+	private static readonly string[] ATTACKERS = { "Zergling", "Hydralisk" };
+
+	private enum State { Setup, Spawning, Warmup, Measuring }
+
+	private class Result {
+		public int size;
+		public int frames;
+		public int alive;
+		public float mean, p50, p95, p99, max; //Frame ms
+		public float[] phases = new float[PHASES]; //ms per frame
+		public int paths;
+		public float pathWait, pathCompute; //ms per path
+		public int collections;
+		public float allocated; //KB per frame
+	}
+
+	private static int[] sizes;
+	private static float seconds = 20;
+	private static string output = "benchmark";
+
+	private static State state;
+	private static int wave;
+	private static int frame; //Of the current state
+	private static int spawned;
+	private static int columns; //Of the spawn grid
+	private static int firstId; //First entity id of the wave
+	private static byte[] initial;
+	private static List<Result> results = new List<Result>();
+
+	//Measures of the current wave
+	private static long[] phaseTicks = new long[PHASES];
+	private static List<float> frameTimes = new List<float>();
+	private static long lastFrame;
+	private static long lastMemory;
+	private static int startCollections;
+	private static float allocated;
+
+	private static object pathLock = new object();
+	private static int paths;
+	private static double pathWait, pathCompute;
+
+	public static bool Running {
+		get { return sizes != null; }
+	}
+
+	// ------------------------------------
+	// GAME LOOP
+	// ------------------------------------
+
+	/**
+	* Read the command line, call after CommandStream.Start and before creating anything
+	*/
+	public static void Start(){
+		sizes = null;
+		results.Clear();
+		initial = null;
+
+		string[] args = Environment.GetCommandLineArgs();
+		string waves = null;
+		for (int i = 0; i < args.Length - 1; i++) {
+			if (args[i] == "-benchmark") waves = args[i+1];
+			else if (args[i] == "-benchmarkSeconds") seconds = float.Parse(args[i+1], CultureInfo.InvariantCulture);
+			else if (args[i] == "-benchmarkOut") output = args[i+1];
+		}
+		if (waves == null) return;
+
+		string[] split = waves.Split(',');
+		sizes = new int[split.Length];
+		for (int i = 0; i < split.Length; i++) sizes[i] = int.Parse(split[i]);
+		Debug.Log ("Benchmark waves " + waves + ", " + seconds + " seconds each");
+
+		//Same game every run, as fast as possible without rendering
+		CommandStream.seed = SEED;
+		UnityEngine.Random.seed = SEED;
+		Time.captureFramerate = CommandStream.FRAME_RATE;
+		QualitySettings.vSyncCount = 0;
+		Application.targetFrameRate = -1;
+		AstarPath.OnPathPostSearch += PathDone;
+
+		state = State.Setup;
+		wave = 0;
+		frame = 0;
+	}
+
+	/**
+	* Advance the waves, call once per frame
+	*/
+	public static void Tick(){
+		if (!Running) return;
+		frame++;
+
+		switch (state) {
+		case State.Setup:
+			foreach (Camera c in Camera.allCameras) c.enabled = false;
+			if (frame < SETUP_FRAMES) return;
+			initial = Snapshot.Save();
+			StartWave();
+			break;
+		case State.Spawning:
+			Spawn();
+			break;
+		case State.Warmup:
+			if (frame < WARMUP_FRAMES) return;
+			StartMeasures();
+			state = State.Measuring;
+			frame = 0;
+			break;
+		case State.Measuring:
+			Measure();
+			if (frame >= seconds * CommandStream.FRAME_RATE || WaveOver()) EndWave();
+			break;
+		}
+	}
+
+	/**
+	* Current timestamp, to measure a phase with Add
+	*/
+	public static long Now(){
+		return Stopwatch.GetTimestamp();
+	}
+
+	/**
+	* Add the time since start to a phase, main thread only
+	*/
+	public static void Add(int phase, long start){
+		if (state != State.Measuring || !Running) return;
+		phaseTicks[phase] += Stopwatch.GetTimestamp() - start;
+	}
+
+	// ------------------------------------
+	// WAVES
+	// ------------------------------------
+
+	private static void StartWave(){
+		Snapshot.Restore(initial);
+		firstId = Entities.NextId;
+		spawned = 0;
+		columns = Mathf.CeilToInt(Mathf.Sqrt(sizes[wave] / 2 + 1));
+		state = State.Spawning;
+		frame = 0;
+		Debug.Log ("Benchmark wave of " + sizes[wave] + " units");
+	}
+
+	/**
+	* Spawn the wave in a few frames, defenders around the main base and attackers on the rush deploys
+	*/
+	private static void Spawn(){
+		Building mainBase = Gameplay.player1.mainBase;
+		GameObject[] deploys = GameObject.FindGameObjectsWithTag("RushDeploy");
+		int size = sizes[wave];
+
+		for (int n = 0; n < SPAWN_PER_FRAME && spawned < size; n++, spawned++) {
+			bool defender = spawned % 2 == 0;
+			int index = spawned / 2;
+			string[] templates = defender ? DEFENDERS : ATTACKERS;
+			string player = defender ? Gameplay.player1.PLAYER_TAG : Gameplay.player2.PLAYER_TAG;
+			Vector3 position;
+			if (defender || deploys.Length == 0) position = mainBase.deploy + Offset(index);
+			else position = deploys[index % deploys.Length].transform.position + Offset(index / deploys.Length);
+			CommandStream.Issue(Command.Spawn(player, templates[index % templates.Length], position));
+		}
+
+		if (spawned >= size) {
+			state = State.Warmup;
+			frame = 0;
+		}
+	}
+
+	/**
+	* Position in a square grid centered on the deploy point
+	*/
+	private static Vector3 Offset(int index){
+		int x = index % columns - columns / 2;
+		int z = index / columns - columns / 2;
+		return new Vector3(x * SPREAD, 0, z * SPREAD);
+	}
+
+	private static bool WaveOver(){
+		if (Gameplay.player1.mainBase == null) return true;
+		if (frame % CommandStream.FRAME_RATE != 0) return false;
+		return Alive(Gameplay.player1.id) == 0 || Alive(Gameplay.player2.id) == 0;
+	}
+
+	private static int Alive(int player){
+		int alive = 0;
+		foreach (Playable p in Teams.Units(player)) {
+			if (p is Unit && p.id >= firstId && p.life > 0) alive++;
+		}
+		return alive;
+	}
+
+	private static void EndWave(){
+		Result r = Results();
+		results.Add(r);
+		Debug.Log ("Benchmark wave of " + r.size + ": " + r.frames + " frames, mean " + r.mean + " ms, p99 " + r.p99 + " ms");
+
+		wave++;
+		if (wave < sizes.Length) StartWave();
+		else Finish();
+	}
+
+	private static void Finish(){
+		AstarPath.OnPathPostSearch -= PathDone;
+		WriteCsv(output + ".csv");
+		WriteJson(output + ".json");
+		Debug.Log ("Benchmark written to " + output + ".csv and " + output + ".json");
+		sizes = null;
+		Application.Quit();
+	}
+
+	// ------------------------------------
+	// MEASURES
+	// ------------------------------------
+
+	private static void StartMeasures(){
+		for (int i = 0; i < PHASES; i++) phaseTicks[i] = 0;
+		frameTimes.Clear();
+		lock (pathLock) {
+			paths = 0;
+			pathWait = 0;
+			pathCompute = 0;
+		}
+		allocated = 0;
+		startCollections = GC.CollectionCount(0);
+		lastMemory = GC.GetTotalMemory(false);
+		lastFrame = Stopwatch.GetTimestamp();
+	}
+
+	private static void Measure(){
+		long now = Stopwatch.GetTimestamp();
+		frameTimes.Add(Milliseconds(now - lastFrame));
+		lastFrame = now;
+
+		//The heap only shrinks on a collection, those frames are not counted
+		long memory = GC.GetTotalMemory(false);
+		if (memory > lastMemory) allocated += memory - lastMemory;
+		lastMemory = memory;
+	}
+
+	/**
+	* Called on the path threads after every search
+	*/
+	private static void PathDone(Path p){
+		double total = (DateTime.UtcNow - p.callTime).TotalMilliseconds;
+		lock (pathLock) {
+			paths++;
+			pathCompute += p.duration;
+			pathWait += Math.Max(0, total - p.duration);
+		}
+	}
+
+	private static Result Results(){
+		Result r = new Result();
+		r.size = sizes[wave];
+		r.frames = frameTimes.Count;
+		r.alive = Alive(Gameplay.player1.id) + Alive(Gameplay.player2.id);
+		if (r.frames == 0) return r;
+
+		List<float> sorted = new List<float>(frameTimes);
+		sorted.Sort();
+		float sum = 0;
+		foreach (float t in sorted) sum += t;
+		r.mean = sum / r.frames;
+		r.p50 = Percentile(sorted, 0.5f);
+		r.p95 = Percentile(sorted, 0.95f);
+		r.p99 = Percentile(sorted, 0.99f);
+		r.max = sorted[sorted.Count - 1];
+
+		for (int i = 0; i < PHASES; i++) r.phases[i] = Milliseconds(phaseTicks[i]) / r.frames;
+		lock (pathLock) {
+			r.paths = paths;
+			if (paths > 0) {
+				r.pathWait = (float) (pathWait / paths);
+				r.pathCompute = (float) (pathCompute / paths);
+			}
+		}
+		r.collections = GC.CollectionCount(0) - startCollections;
+		r.allocated = allocated / 1024 / r.frames;
+		return r;
+	}
+
+	private static float Percentile(List<float> sorted, float percentile){
+		return sorted[Mathf.Min(sorted.Count - 1, (int) (percentile * sorted.Count))];
+	}
+
+	private static float Milliseconds(long ticks){
+		return (float) (ticks * 1000.0 / Stopwatch.Frequency);
+	}
+
+	// ------------------------------------
+	// OUTPUT
+	// ------------------------------------
+
+	private static void WriteCsv(string path){
+		StringBuilder csv = new StringBuilder();
+		csv.Append("units,frames,alive,frame_mean_ms,frame_p50_ms,frame_p95_ms,frame_p99_ms,frame_max_ms");
+		foreach (string name in PHASE_NAMES) csv.Append(",").Append(name).Append("_ms");
+		csv.Append(",paths,path_wait_ms,path_compute_ms,gc_collections,allocated_kb_per_frame\n");
+
+		foreach (Result r in results) {
+			csv.Append(r.size).Append(',').Append(r.frames).Append(',').Append(r.alive);
+			foreach (float f in new float[]{ r.mean, r.p50, r.p95, r.p99, r.max }) csv.Append(',').Append(Format(f));
+			foreach (float f in r.phases) csv.Append(',').Append(Format(f));
+			csv.Append(',').Append(r.paths);
+			csv.Append(',').Append(Format(r.pathWait)).Append(',').Append(Format(r.pathCompute));
+			csv.Append(',').Append(r.collections).Append(',').Append(Format(r.allocated)).Append('\n');
+		}
+		File.WriteAllText(path, csv.ToString());
+	}
+
+	private static void WriteJson(string path){
+		StringBuilder json = new StringBuilder();
+		json.Append("{\n\t\"seconds\": ").Append(Format(seconds));
+		json.Append(",\n\t\"frameRate\": ").Append(CommandStream.FRAME_RATE);
+		json.Append(",\n\t\"waves\": [");
+		for (int i = 0; i < results.Count; i++) {
+			Result r = results[i];
+			json.Append(i == 0 ? "\n\t\t{" : ",\n\t\t{");
+			json.Append("\"units\": ").Append(r.size);
+			json.Append(", \"frames\": ").Append(r.frames);
+			json.Append(", \"alive\": ").Append(r.alive);
+			json.Append(", \"frameMs\": {\"mean\": ").Append(Format(r.mean));
+			json.Append(", \"p50\": ").Append(Format(r.p50));
+			json.Append(", \"p95\": ").Append(Format(r.p95));
+			json.Append(", \"p99\": ").Append(Format(r.p99));
+			json.Append(", \"max\": ").Append(Format(r.max)).Append("}");
+			json.Append(", \"phaseMs\": {");
+			for (int p = 0; p < PHASES; p++) json.Append(p == 0 ? "\"" : ", \"").Append(PHASE_NAMES[p]).Append("\": ").Append(Format(r.phases[p]));
+			json.Append("}");
+			json.Append(", \"paths\": ").Append(r.paths);
+			json.Append(", \"pathWaitMs\": ").Append(Format(r.pathWait));
+			json.Append(", \"pathComputeMs\": ").Append(Format(r.pathCompute));
+			json.Append(", \"gcCollections\": ").Append(r.collections);
+			json.Append(", \"allocatedKbPerFrame\": ").Append(Format(r.allocated));
+			json.Append("}");
+		}
+		json.Append("\n\t]\n}\n");
+		File.WriteAllText(path, json.ToString());
+	}
+
+	private static string Format(float f){
+		return f.ToString("0.###", CultureInfo.InvariantCulture);
+	}
+}
@@ -0,0 +1,99 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Combat phase, resolved once per frame after all the units have been updated.
+*
+* Attacks are gathered in a buffer during the frame (see Playable.performAttack and Projectiles), then:
+*  1. damage and armor are applied in one pass,
+*  2. dead units are removed,
+*  3. presentation (sparks and damage text) is dispatched with a cap per frame, extra events
+*     are dropped, which only happens in big fights. Attack sounds go to AudioEvents, which has its own limits.
+*/
+public class Combat {
+
+	public const int MAX_SPARKS_PER_FRAME = 12;
+	public const int MAX_DAMAGE_TEXTS_PER_FRAME = 12;
+
+	public struct AttackEvent {
+		public Playable attacker;
+		public Playable target;
+		public int damage;
+		public AudioClip audio;
+	}
+
+	private struct HitEvent {
+		public Playable attacker;
+		public Playable target;
+		public int damage;
+		public AudioClip audio;
+		public Vector3 position;
+	}
+
+	private static List<AttackEvent> attacks = new List<AttackEvent>();
+	private static List<HitEvent> hits = new List<HitEvent>();
+	private static List<Playable> dead = new List<Playable>();
+
+	public static int droppedLastFrame; //Presentation events over the caps in the last frame
+
+	/**
+	* Queue an attack, resolved at the end of the frame
+	*/
+	public static void Attack(Playable attacker, Playable target, int damage, AudioClip audio){
+		AttackEvent e = new AttackEvent();
+		e.attacker = attacker;
+		e.target = target;
+		e.damage = damage;
+		e.audio = audio;
+		attacks.Add(e);
+	}
+
+	public static void Resolve(){
+		ApplyDamage();
+		ResolveDeaths();
+		Present();
+
+		attacks.Clear();
+		hits.Clear();
+		dead.Clear();
+	}
+
+	private static void ApplyDamage(){
+		for (int i = 0; i < attacks.Count; i++) {
+			AttackEvent e = attacks[i];
+			if (e.target == null || e.target.life <= 0) continue; //Already dead this frame
+
+			int damage = e.target.TakeDamage(e.damage);
+			if (e.target.life <= 0) dead.Add(e.target);
+
+			HitEvent hit = new HitEvent();
+			hit.attacker = e.attacker;
+			hit.target = e.target;
+			hit.damage = damage;
+			hit.audio = e.audio;
+			hit.position = e.target.transform.position;
+			hits.Add(hit);
+		}
+	}
+
+	private static void ResolveDeaths(){
+		foreach (Playable p in dead) p.Die();
+	}
+
+	private static void Present(){
+		int sparks = 0, texts = 0;
+		droppedLastFrame = 0;
+
+		foreach (HitEvent hit in hits) {
+			if (hit.audio != null && hit.attacker != null) AudioEvents.Play(hit.audio, hit.attacker.transform.position, AudioEvents.PRIORITY_ATTACK);
+
+			if (sparks++ < MAX_SPARKS_PER_FRAME) Effects.Sparks(hit.position);
+			else droppedLastFrame++;
+
+			if (Prefs.showDamage && hit.target != null && hit.target.life > 0) {
+				if (texts++ < MAX_DAMAGE_TEXTS_PER_FRAME) hit.target.ShowDamage(hit.damage);
+				else droppedLastFrame++;
+			}
+		}
+	}
+}
@@ -42,7 +42,7 @@ public class Controller : MonoBehaviour {
 		downPosition = Input.mousePosition;
 		dragPosition = Input.mousePosition;
 
-		if (GameObject.Find("Minimap") != null) minimap = GameObject.Find("Minimap").GetComponent<Camera>().pixelRect.Contains (downPosition);
+		minimap = Minimap.Contains (downPosition);
 	}   
 
 	void OnMouseUp(){
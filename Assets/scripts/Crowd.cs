@@ -0,0 +1,237 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.Threading;
+
+/**
+* Local avoidance for the mobile units, so groups spread instead of collapsing into a point.
+*
+* Units register every frame with the velocity they want (see Playable.moving), then Step
+* solves all of them at once: neighbours come from a shared SpatialHash, and each agent picks
+* among sampled candidate velocities the one closest to its preferred velocity with the largest
+* time to collision, using reciprocal velocity obstacles (RVO: each agent takes half of the effort).
+*
+* The solve only reads the arrays built at the beginning of the step and writes one velocity
+* per agent, so it can be split across threads (see threads). The worker callback, the event and the
+* neighbour buffers of every chunk are created once, a threaded step doesn't allocate.
+*/
+public class Crowd {
+
+	public static int threads = 1; //Worker threads for the solve, 1 solves on the main thread
+
+	private const float NEIGHBOUR_RADIUS = 4;
+	private const int MAX_NEIGHBOURS = 8;
+	private const float TIME_HORIZON = 2; //Seconds
+	private const float COLLISION_WEIGHT = 1.5f;
+	private const int CANDIDATE_ANGLES = 8;
+
+	private static Playable[] units = new Playable[64];
+	private static Vector2[] positions = new Vector2[64];
+	private static Vector2[] preferred = new Vector2[64];
+	private static Vector2[] velocities = new Vector2[64]; //Last solved velocity, used by neighbours
+	private static Vector2[] solved = new Vector2[64];
+	private static float[] radius = new float[64];
+	private static float[] maxSpeed = new float[64];
+	private static float[] climb = new float[64];
+	private static UnitType[] layer = new UnitType[64];
+	private static int count = 0;
+
+	private static Dictionary<int, Vector2> lastVelocity = new Dictionary<int, Vector2>();
+	private static SpatialHash hash = new SpatialHash(NEIGHBOUR_RADIUS);
+	private static Vector2[] candidates = BuildCandidates();
+
+	//Threaded solve, see SolveThreaded
+	private static int[][] neighbourBuffers = new int[0][]; //Per chunk, the first one also for the single thread solve
+	private static object[] chunkIds = new object[0]; //Boxed once
+	private static bool[] chunkFailed = new bool[0]; //Set by a worker whose chunk threw
+	private static WaitCallback solveChunk = SolveChunk;
+	private static ManualResetEvent done = new ManualResetEvent(false);
+	private static int pending;
+	private static int chunkSize;
+	private static System.Exception failure; //First exception of a worker, logged on the main thread
+
+	/**
+	* Register a unit for this step with its preferred velocity (zero if idle)
+	*/
+	public static void Move(Playable unit, Vector3 velocity){
+		if (count == units.Length) Grow();
+
+		Vector3 pos = unit.transform.position;
+		units[count] = unit;
+		positions[count] = new Vector2(pos.x, pos.z);
+		preferred[count] = new Vector2(velocity.x, velocity.z);
+		climb[count] = velocity.y;
+		maxSpeed[count] = unit.speed;
+		radius[count] = unit.Radius();
+		layer[count] = unit.type;
+
+		Vector2 last;
+		velocities[count] = lastVelocity.TryGetValue(unit.id, out last) ? last : preferred[count];
+		count++;
+	}
+
+	/**
+	* Solve and move all the registered units, call once per frame after the units update
+	*/
+	public static void Step(float dt){
+		hash.Build(positions, count);
+
+		if (threads <= 1 || count < 64) Solve(0, count, Neighbours(0));
+		else SolveThreaded();
+
+		lastVelocity.Clear();
+		for (int i = 0; i < count; i++) {
+			Playable unit = units[i];
+			units[i] = null;
+			if (unit == null) continue;
+
+			lastVelocity[unit.id] = solved[i];
+			if (solved[i] == Vector2.zero && climb[i] == 0) continue;
+			unit.transform.position += new Vector3(solved[i].x, climb[i], solved[i].y) * dt;
+			Entities.MarkChanged(unit);
+		}
+		count = 0;
+	}
+
+	private static void SolveThreaded(){
+		Neighbours(threads - 1); //Buffers are created on the main thread
+		chunkSize = (count + threads - 1) / threads;
+		failure = null;
+		pending = threads;
+		done.Reset();
+
+		for (int t = 0; t < threads; t++) {
+			chunkFailed[t] = false;
+			ThreadPool.QueueUserWorkItem(solveChunk, chunkIds[t]);
+		}
+		done.WaitOne();
+		if (failure == null) return;
+
+		//The units of a failed chunk may have partly written or stale slots, they stand still this step
+		Debug.LogError("Crowd solve failed " + failure);
+		for (int t = 0; t < threads; t++) {
+			if (!chunkFailed[t]) continue;
+			int from = t * chunkSize;
+			for (int i = from; i < Mathf.Min(count, from + chunkSize); i++) solved[i] = Vector2.zero;
+		}
+	}
+
+	private static void SolveChunk(object state){
+		int chunk = (int) state;
+		try {
+			int from = chunk * chunkSize;
+			Solve(from, Mathf.Min(count, from + chunkSize), neighbourBuffers[chunk]);
+		} catch (System.Exception e) {
+			chunkFailed[chunk] = true;
+			Interlocked.CompareExchange(ref failure, e, null);
+		} finally {
+			if (Interlocked.Decrement(ref pending) == 0) done.Set();
+		}
+	}
+
+	/**
+	* Neighbour buffer of a chunk, main thread only
+	*/
+	private static int[] Neighbours(int chunk){
+		if (chunk >= neighbourBuffers.Length) {
+			int previous = neighbourBuffers.Length;
+			System.Array.Resize(ref neighbourBuffers, chunk + 1);
+			System.Array.Resize(ref chunkIds, chunk + 1);
+			System.Array.Resize(ref chunkFailed, chunk + 1);
+			for (int i = previous; i <= chunk; i++) {
+				neighbourBuffers[i] = new int[MAX_NEIGHBOURS + 1];
+				chunkIds[i] = i;
+			}
+		}
+		return neighbourBuffers[chunk];
+	}
+
+	private static void Solve(int from, int to, int[] neighbours){
+		for (int i = from; i < to; i++) {
+			int found = hash.Query(positions[i], NEIGHBOUR_RADIUS, neighbours);
+
+			Vector2 best = preferred[i];
+			float bestCost = float.MaxValue;
+			float speed = Mathf.Max(maxSpeed[i], preferred[i].magnitude);
+			Vector2 direction = preferred[i] == Vector2.zero ? Vector2.right : preferred[i].normalized;
+
+			for (int c = 0; c < candidates.Length; c++) {
+				Vector2 candidate;
+				if (c == 0) candidate = preferred[i];
+				else candidate = Rotate(direction, candidates[c]) * speed * candidates[c].magnitude;
+
+				float toi = TimeToCollision(i, candidate, neighbours, found);
+				float cost = COLLISION_WEIGHT / Mathf.Max(toi, 0.01f) + (candidate - preferred[i]).magnitude;
+				if (cost < bestCost) {
+					bestCost = cost;
+					best = candidate;
+				}
+				if (toi >= TIME_HORIZON && c == 0) break; //Preferred velocity is free
+			}
+			solved[i] = best;
+		}
+	}
+
+	/**
+	* Smallest time to collision with the neighbours if moving with velocity v (reciprocal: 2v - vi)
+	*/
+	private static float TimeToCollision(int i, Vector2 v, int[] neighbours, int found){
+		float min = TIME_HORIZON;
+		for (int n = 0; n < found; n++) {
+			int j = neighbours[n];
+			if (j == i || layer[j] != layer[i]) continue;
+
+			Vector2 relativePos = positions[j] - positions[i];
+			Vector2 relativeVel = 2 * v - velocities[i] - velocities[j];
+			float r = radius[i] + radius[j];
+
+			float c = relativePos.sqrMagnitude - r * r;
+			if (c < 0) {
+				//Already overlapping, only accept velocities moving apart
+				if (Vector2.Dot(relativePos, relativeVel) > 0) return 0;
+				continue;
+			}
+			float a = relativeVel.sqrMagnitude;
+			float b = Vector2.Dot(relativePos, relativeVel);
+			float discr = b * b - a * c;
+			if (a == 0 || b <= 0 || discr <= 0) continue;
+
+			float t = (b - Mathf.Sqrt(discr)) / a;
+			if (t < min) min = t;
+		}
+		return min;
+	}
+
+	/**
+	* Candidate directions (relative to the preferred direction) and speed factors
+	*/
+	private static Vector2[] BuildCandidates(){
+		List<Vector2> list = new List<Vector2>();
+		list.Add(Vector2.zero); //Preferred velocity
+		foreach (float speed in new float[]{1, 0.5f}) {
+			for (int a = 0; a < CANDIDATE_ANGLES; a++) {
+				float angle = a * Mathf.PI * 2 / CANDIDATE_ANGLES;
+				list.Add(new Vector2(Mathf.Cos(angle), Mathf.Sin(angle)) * speed);
+			}
+		}
+		list.Add(new Vector2(0.0001f, 0)); //Stop
+		return list.ToArray();
+	}
+
+	private static Vector2 Rotate(Vector2 v, Vector2 by){
+		by.Normalize();
+		return new Vector2(v.x * by.x - v.y * by.y, v.x * by.y + v.y * by.x);
+	}
+
+	private static void Grow(){
+		int size = units.Length * 2;
+		System.Array.Resize(ref units, size);
+		System.Array.Resize(ref positions, size);
+		System.Array.Resize(ref preferred, size);
+		System.Array.Resize(ref velocities, size);
+		System.Array.Resize(ref solved, size);
+		System.Array.Resize(ref radius, size);
+		System.Array.Resize(ref maxSpeed, size);
+		System.Array.Resize(ref climb, size);
+		System.Array.Resize(ref layer, size);
+	}
+}
@@ -0,0 +1,371 @@
+using UnityEngine;
+using System.Collections.Generic;
+using Pathfinding;
+
+/**
+* Harvest scheduling for all the workers, instead of every worker looking for its base every frame.
+*
+* A worker collecting a resource is a harvester that cycles:
+*  ToPatch -> Mining -> ToBase -> Dropping -> ToPatch ...
+*
+* Mining and dropping are timers kept in a heap, so only the harvesters whose timer expired are
+* advanced. The closest base of every patch and the trip path between them are calculated once
+* per patch (a Route) and reused by all its workers, the way back is the same path reversed.
+* A worker only follows the route when it starts the trip at its end (eg: not when it comes from elsewhere),
+* else that first trip is pathed on its own.
+* Deposits are added to the players once per frame.
+*/
+public class Economy {
+
+	public enum Trip {
+		ToPatch,
+		Mining,
+		ToBase,
+		Dropping
+	}
+
+	public const int MAX_RESOURCE = 8; //Carried per trip
+	public const float DROP_TIME = 1;
+	private const float NEXT_PATCH_RADIUS = 12; //Looking for another patch when one is depleted
+	private const float ROUTE_RADIUS = 4; //Max distance to the start of a route to follow it
+
+	private class Harvester {
+		public Worker worker;
+		public int workerId;
+		public Resource patch;
+		public Vector3 patchPosition;
+		public int type;
+		public Route route;
+		public Trip state;
+		public float until; //Timer end (Mining, Dropping)
+		public bool active = true;
+	}
+
+	private class Route {
+		public Building depot;
+		public List<Vector3> path; //From the patch to the depot, null until calculated
+		public bool requested;
+	}
+
+	private static List<Harvester> harvesters = new List<Harvester>();
+	private static Dictionary<int, Harvester> byWorker = new Dictionary<int, Harvester>();
+	private static List<Harvester> timers = new List<Harvester>(); //Min heap by until
+
+	//Routes per player and patch id
+	private static Dictionary<string, Dictionary<int, Route>> routes = new Dictionary<string, Dictionary<int, Route>>();
+	private static Dictionary<string, int[]> deposits = new Dictionary<string, int[]>();
+
+	// ------------------------------------
+	// ORDERS
+	// ------------------------------------
+
+	/**
+	* Start harvesting patch with worker, replacing its previous assignment
+	*/
+	public static void Assign(Worker worker, Resource patch){
+		Release(worker);
+		if (patch == null) return;
+		patch.Register();
+
+		Harvester h = new Harvester();
+		h.worker = worker;
+		h.workerId = worker.id;
+		byWorker[worker.id] = h;
+		harvesters.Add(h);
+
+		SetPatch(h, patch);
+		//Workers already carrying resources drop them first
+		if (worker.carried > 0) GoToBase(h);
+		else GoToPatch(h);
+	}
+
+	public static void Release(Worker worker){
+		Harvester h;
+		if (!byWorker.TryGetValue(worker.id, out h)) return;
+
+		h.active = false; //Removed from the lists on the next tick
+		byWorker.Remove(worker.id);
+		worker.Working(false);
+	}
+
+	public static bool IsHarvesting(Worker worker){
+		return byWorker.ContainsKey(worker.id);
+	}
+
+	/**
+	* Deposit what the worker carries (eg: moved close to a base by the player)
+	*/
+	public static void Deposit(Worker worker){
+		if (worker.carried == 0) return;
+		Deposits(worker.tag)[worker.carriedType] += worker.carried;
+		worker.carried = 0;
+	}
+
+	/**
+	* Bases changed for a player (eg: a new base was built), routes are recalculated
+	*/
+	public static void DepotsChanged(string tag){
+		routes.Remove(tag);
+		foreach (Harvester h in harvesters) if (h.worker != null && h.worker.tag == tag) h.route = null;
+	}
+
+	public static bool IsDepot(Building b){
+		return b.name.Contains("Base"); //a clone object will contain (Clone) in the name
+	}
+
+	public static void Reset(){
+		harvesters.Clear();
+		byWorker.Clear();
+		timers.Clear();
+		routes.Clear();
+		deposits.Clear();
+	}
+
+	// ------------------------------------
+	// UPDATE
+	// ------------------------------------
+
+	/**
+	* Advance the harvesters, call once per frame
+	*/
+	public static void Tick(){
+		//Expired timers
+		while (timers.Count > 0 && timers[0].until <= Time.time) {
+			Harvester h = PopTimer();
+			if (!h.active || h.worker == null) continue;
+			if (h.state == Trip.Mining) FinishMining(h);
+			else if (h.state == Trip.Dropping) FinishDropping(h);
+		}
+
+		//Arrivals, only a state check for the harvesters still walking
+		int alive = 0;
+		for (int i = 0; i < harvesters.Count; i++) {
+			Harvester h = harvesters[i];
+			if (!h.active || h.worker == null) {
+				if (h.active) byWorker.Remove(h.workerId); //Dead worker
+				h.active = false;
+				continue;
+			}
+			harvesters[alive++] = h;
+
+			if (h.state == Trip.ToPatch) {
+				if (h.patch == null && !NextPatch(h)) {
+					Stop(h);
+					continue;
+				}
+				if (Arrived(h, h.patch)) StartMining(h);
+			} else if (h.state == Trip.ToBase) {
+				Building depot = Depot(h);
+				if (depot == null) continue; //Wait for a base
+				if (Arrived(h, depot)) StartDropping(h);
+			}
+		}
+		harvesters.RemoveRange(alive, harvesters.Count - alive);
+
+		//Batched deposits
+		foreach (KeyValuePair<string, int[]> d in deposits) {
+			if (d.Value[0] == 0 && d.Value[1] == 0) continue;
+			Player player = Gameplay.getPlayer(d.Key);
+			if (player != null) player.addResources(d.Value);
+			System.Array.Clear(d.Value, 0, d.Value.Length);
+		}
+	}
+
+	private static bool Arrived(Harvester h, MonoBehaviour target){
+		PathFollower.State movement = h.worker.MovementState();
+		if (movement != PathFollower.State.Arrived && movement != PathFollower.State.Idle) return false;
+		//End of the route (or no route), the last meters are a direct path
+		return h.worker.GoCloser(target);
+	}
+
+	// ------------------------------------
+	// HARVEST STATES
+	// ------------------------------------
+
+	private static void GoToPatch(Harvester h){
+		h.state = Trip.ToPatch;
+		if (h.patch == null) return; //Depleted, see NextPatch
+		Route route = RouteOf(h);
+		if (OnRoute(h, route, true)) h.worker.FollowPath(route.path, true);
+		else h.worker.goTo(h.patch);
+	}
+
+	private static void StartMining(Harvester h){
+		h.state = Trip.Mining;
+		h.worker.Working(true);
+		Effects.Bluesparks(h.patch.transform.position);
+		StartTimer(h, MAX_RESOURCE * h.patch.SPEED_COLLECTION);
+	}
+
+	private static void FinishMining(Harvester h){
+		h.worker.Working(false);
+		if (h.patch != null) {
+			int amount = Mathf.Min(MAX_RESOURCE, h.patch.quantity);
+			h.worker.carried = amount;
+			h.worker.carriedType = h.patch.type;
+			h.patch.consume(amount); //Destroyed when depleted, see NextPatch
+		}
+		if (h.worker.carried > 0) GoToBase(h);
+		else GoToPatch(h); //Depleted by other workers while mining
+	}
+
+	private static void GoToBase(Harvester h){
+		h.state = Trip.ToBase;
+		Route route = RouteOf(h);
+		if (OnRoute(h, route, false)) h.worker.FollowPath(route.path, false);
+		else if (route != null && route.depot != null) h.worker.goTo(route.depot);
+	}
+
+	/**
+	* True if the route is calculated and the worker is at its start (the depot end if reversed)
+	*/
+	private static bool OnRoute(Harvester h, Route route, bool reversed){
+		if (route == null || route.path == null || route.path.Count == 0) return false;
+		Vector3 start = route.path[reversed ? route.path.Count - 1 : 0];
+		Vector3 offset = start - h.worker.transform.position;
+		offset.y = 0;
+		return offset.sqrMagnitude <= ROUTE_RADIUS * ROUTE_RADIUS;
+	}
+
+	private static void StartDropping(Harvester h){
+		h.state = Trip.Dropping;
+		StartTimer(h, DROP_TIME);
+	}
+
+	private static void FinishDropping(Harvester h){
+		Deposit(h.worker);
+		GoToPatch(h);
+	}
+
+	private static void Stop(Harvester h){
+		h.worker.resource = null;
+		Release(h.worker);
+	}
+
+	private static void SetPatch(Harvester h, Resource patch){
+		h.patch = patch;
+		h.patchPosition = patch.transform.position;
+		h.type = patch.type;
+		h.route = null;
+		h.worker.resource = patch;
+	}
+
+	/**
+	* Closest patch of the same type to a depleted one
+	*/
+	private static bool NextPatch(Harvester h){
+		Resource closest = null;
+		float closestDistance = NEXT_PATCH_RADIUS * NEXT_PATCH_RADIUS;
+		foreach (MonoBehaviour m in Entities.All) {
+			Resource r = m as Resource;
+			if (r == null || r.quantity <= 0 || r.type != h.type) continue;
+			float distance = (r.transform.position - h.patchPosition).sqrMagnitude;
+			if (distance < closestDistance) {
+				closest = r;
+				closestDistance = distance;
+			}
+		}
+		if (closest == null) return false;
+		SetPatch(h, closest);
+		GoToPatch(h);
+		return true;
+	}
+
+	// ------------------------------------
+	// ROUTES
+	// ------------------------------------
+
+	private static Building Depot(Harvester h){
+		Route route = RouteOf(h);
+		return route != null ? route.depot : null;
+	}
+
+	/**
+	* Route of the harvester patch, shared by all the workers of the player in that patch
+	*/
+	private static Route RouteOf(Harvester h){
+		if (h.route != null && h.route.depot != null) return h.route;
+		if (h.patch == null) return null;
+
+		string tag = h.worker.tag;
+		Dictionary<int, Route> playerRoutes;
+		if (!routes.TryGetValue(tag, out playerRoutes)) {
+			playerRoutes = new Dictionary<int, Route>();
+			routes[tag] = playerRoutes;
+		}
+
+		Route route;
+		if (!playerRoutes.TryGetValue(h.patch.id, out route) || route.depot == null) {
+			route = new Route();
+			route.depot = Utils.closest<Building>("Base", tag, h.patch.transform.position);
+			if (route.depot == null) return null;
+			playerRoutes[h.patch.id] = route;
+		}
+		if (!route.requested) RequestPath(route, h.patch);
+
+		h.route = route;
+		return route;
+	}
+
+	private static void RequestPath(Route route, Resource patch){
+		route.requested = true;
+		if (AstarPath.active == null) return;
+
+		Vector3 from = patch.GetComponent<Collider>().ClosestPointOnBounds(route.depot.transform.position);
+		Vector3 to = route.depot.GetComponent<Collider>().ClosestPointOnBounds(patch.transform.position);
+		AstarPath.StartPath(ABPath.Construct(from, to, delegate (Path p) {
+			p.Claim(route);
+			if (!p.error) route.path = new List<Vector3>(p.vectorPath);
+			p.Release(route);
+		}));
+	}
+
+	// ------------------------------------
+	// TIMERS AND DEPOSITS
+	// ------------------------------------
+
+	private static int[] Deposits(string tag){
+		int[] d;
+		if (!deposits.TryGetValue(tag, out d)) {
+			d = new int[2]; //{mineral, gas}, see Player.resources
+			deposits[tag] = d;
+		}
+		return d;
+	}
+
+	private static void StartTimer(Harvester h, float seconds){
+		h.until = Time.time + seconds;
+		timers.Add(h);
+		int i = timers.Count - 1;
+		while (i > 0) {
+			int parent = (i - 1) / 2;
+			if (timers[parent].until <= timers[i].until) break;
+			Swap(i, parent);
+			i = parent;
+		}
+	}
+
+	private static Harvester PopTimer(){
+		Harvester top = timers[0];
+		int last = timers.Count - 1;
+		timers[0] = timers[last];
+		timers.RemoveAt(last);
+
+		int i = 0;
+		while (true) {
+			int left = i * 2 + 1, right = left + 1, smallest = i;
+			if (left < timers.Count && timers[left].until < timers[smallest].until) smallest = left;
+			if (right < timers.Count && timers[right].until < timers[smallest].until) smallest = right;
+			if (smallest == i) break;
+			Swap(i, smallest);
+			i = smallest;
+		}
+		return top;
+	}
+
+	private static void Swap(int a, int b){
+		Harvester t = timers[a];
+		timers[a] = timers[b];
+		timers[b] = t;
+	}
+}
@@ -0,0 +1,116 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Registry of the game entities (units, buildings and resources) by id.
+* Ids are given in creation order, so replaying the same orders creates the same ids (see CommandStream)
+*
+* It also keeps the units that changed (registered, moved or damaged) and the ids removed since the last
+* ClearChanges, so the grids over the map (see InfluenceMap) only update those instead of every entity.
+*/
+public class Entities {
+
+	private static int nextId = 1;
+	private static Dictionary<int, MonoBehaviour> entities = new Dictionary<int, MonoBehaviour>();
+	private static List<Playable> changed = new List<Playable>();
+	private static List<int> removed = new List<int>();
+
+	public static int Register(MonoBehaviour entity){
+		int id = nextId++;
+		entities[id] = entity;
+		Added(entity);
+		return id;
+	}
+
+	/**
+	* Register with a given id (eg: restoring a snapshot), replacing any entity with that id
+	*/
+	public static int Register(MonoBehaviour entity, int id){
+		entities[id] = entity;
+		if (id >= nextId) nextId = id + 1;
+		Added(entity);
+		return id;
+	}
+
+	public static void Unregister(int id){
+		if (entities.Remove(id)) removed.Add(id);
+	}
+
+	private static void Added(MonoBehaviour entity){
+		Playable p = entity as Playable;
+		if (p != null) MarkChanged(p);
+	}
+
+	/**
+	* Entity with the given id, null if it doesn't exist anymore or is not a T
+	*/
+	public static T Get<T>(int id) where T : MonoBehaviour {
+		MonoBehaviour entity;
+		if (entities.TryGetValue(id, out entity) && entity != null) return entity as T;
+		return null;
+	}
+
+	/**
+	* All the entities, do not create or destroy entities while iterating
+	*/
+	public static Dictionary<int, MonoBehaviour>.ValueCollection All {
+		get { return entities.Values; }
+	}
+
+	public static int Count {
+		get { return entities.Count; }
+	}
+
+	// ------------------------------------
+	// CHANGES
+	// ------------------------------------
+
+	/**
+	* Add a unit whose position or values changed (eg: moved by Crowd, damaged), once per ClearChanges
+	*/
+	public static void MarkChanged(Playable p){
+		if (p.changeQueued) return;
+		p.changeQueued = true;
+		changed.Add(p);
+	}
+
+	/**
+	* Units changed since the last ClearChanges, do not modify. They can be destroyed or unregistered since (check the id)
+	*/
+	public static List<Playable> Changed {
+		get { return changed; }
+	}
+
+	/**
+	* Ids unregistered since the last ClearChanges, do not modify. An id can be registered again by a restored entity
+	*/
+	public static List<int> Removed {
+		get { return removed; }
+	}
+
+	/**
+	* Called once per frame, after every grid read the changes (see Gameplay.Update)
+	*/
+	public static void ClearChanges(){
+		for (int i = 0; i < changed.Count; i++) changed[i].changeQueued = false;
+		changed.Clear();
+		removed.Clear();
+	}
+
+	/**
+	* Id of the next registered entity, saved in snapshots so restored games keep creating the same ids
+	*/
+	public static int NextId {
+		get { return nextId; }
+		set { nextId = value; }
+	}
+
+	/**
+	* Called when the level is unloaded, so a restarted game gets the same ids
+	*/
+	public static void Reset(){
+		nextId = 1;
+		entities.Clear();
+		ClearChanges();
+	}
+}
@@ -37,6 +37,9 @@ public class Gameplay : MonoBehaviour {
 	void Start () {
 
 		startGame = Time.time;
+		CommandStream.Start();
+		Snapshot.Start();
+		Benchmark.Start();
 		//adjustMinimap ();
 		defeatMenu.SetActive(false);
 		
@@ -46,6 +49,15 @@ public class Gameplay : MonoBehaviour {
 		//player2 = new Human("player2");
 		player1 = GameObject.Find("player1").GetComponent<Player>();
 		player2 = GameObject.Find("player2").GetComponent<Player>();
+
+		//Ids in a fixed order: player1, player2, then player3..player8 if the map has them
+		Teams.Reset();
+		Teams.Register(player1);
+		Teams.Register(player2);
+		for (int i = 3; i <= Teams.MAX_PLAYERS; i++) {
+			GameObject other = GameObject.Find("player" + i);
+			if (other != null && other.GetComponent<Player>() != null) Teams.Register(other.GetComponent<Player>());
+		}
 		
 		Debug.Log ("player1 " + player1);
 		Debug.Log ("player2 " + player2);
@@ -53,6 +65,7 @@ public class Gameplay : MonoBehaviour {
 		//addPlayerObject("player1");
 		//addPlayerObject("player2");
 
+		Resource.RegisterAll();
 		createBases();
 		createUnits();
 
@@ -148,12 +161,39 @@ public class Gameplay : MonoBehaviour {
 	}
 	
 	void Update(){
+		CommandStream.Tick();
+		Snapshot.Tick();
+		Benchmark.Tick();
+
+		//Grids read by the AI, measured in its phase
+		bool measure = Benchmark.Running;
+		long start = measure ? Benchmark.Now() : 0;
+		if (InfluenceMap.Get() != null) InfluenceMap.Get().Tick();
+		Visibility.Get().Tick();
+		if (measure) Benchmark.Add(Benchmark.AI, start);
+		Entities.ClearChanges();
+		Economy.Tick();
+		Minimap.Update();
 		//player2.update();
 		//adjustMinimap ();
 		if (isGameEnd() && !gameEnded) gameEnd();
 	}
 
 
+	void LateUpdate(){
+		bool measure = Benchmark.Running;
+		long start = measure ? Benchmark.Now() : 0;
+		Crowd.Step(Time.deltaTime);
+		if (measure) {
+			Benchmark.Add(Benchmark.MOVEMENT, start);
+			start = Benchmark.Now();
+		}
+		Projectiles.Step(Time.deltaTime);
+		Combat.Resolve();
+		if (measure) Benchmark.Add(Benchmark.COMBAT, start);
+		AudioEvents.Flush();
+	}
+
 	private bool isGameEnd(){
 		return player1.mainBase == null;
 	}
@@ -161,6 +201,7 @@ public class Gameplay : MonoBehaviour {
 	private void gameEnd(){
 		gameEnded = true;
 		defeatMenu.SetActive(true);
+		CommandStream.Stop();
 
 		//Send amplitude stats
 		float timeAlive = Time.time ;
@@ -171,20 +212,27 @@ public class Gameplay : MonoBehaviour {
 
 	}
 
-	public static Player getPlayer(string tag){
-		switch (tag){
-			case "player1": return player1;
-			case "player2": return player2;
-			default: return null;
-		}
+	void OnApplicationQuit(){
+		CommandStream.Stop();
 	}
-	
-	//TODO make it scalable (more players)
-	public static string enemies(string tag){
-		switch (tag) {
-		case "player1": return "player2"; break;
-		case "player2": return "player1"; break;
-		}
-		return null;
+
+	void OnDestroy(){
+		CommandStream.Stop();
+		Entities.Reset();
+		Teams.Reset();
+		Economy.Reset();
+		InfluenceMap.Reset();
+		Visibility.Reset();
+		Minimap.Reset();
+		AudioEvents.Reset();
+		Projectiles.Reset();
+		Templates.Reset();
+	}
+
+	/**
+	* Player of a tag, null if it's not a player. Hot paths use the player ids, see Teams
+	*/
+	public static Player getPlayer(string tag){
+		return Teams.Get(Teams.Id(tag));
 	}
 }
@@ -0,0 +1,141 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Snapshot of the terrain heights in a flat array.
+* Heights are copied once from the TerrainData (main thread) and never modified afterwards,
+* so sampling is safe from the pathfinding and simulation threads.
+*/
+public class Heightfield {
+
+	private static volatile Heightfield current;
+	private static readonly object loadLock = new object();
+
+	private readonly float[] heights; //[z * width + x], in world units
+	private readonly int width;
+	private readonly int depth;
+	private readonly Vector3 origin;
+	private readonly Vector3 size;
+	private readonly float invCellX;
+	private readonly float invCellZ;
+
+	private Heightfield(Terrain terrain){
+		TerrainData data = terrain.terrainData;
+		width = data.heightmapWidth;
+		depth = data.heightmapHeight;
+		origin = terrain.transform.position;
+		size = data.size;
+		invCellX = (width - 1) / size.x;
+		invCellZ = (depth - 1) / size.z;
+
+		//GetHeights returns normalized values indexed [z,x]
+		float[,] normalized = data.GetHeights(0, 0, width, depth);
+		heights = new float[width * depth];
+		for (int z = 0; z < depth; z++) {
+			for (int x = 0; x < width; x++) {
+				heights[z * width + x] = origin.y + normalized[z, x] * size.y;
+			}
+		}
+		Debug.Log ("Heightfield loaded " + width + "x" + depth);
+	}
+
+	// ------------------------------------
+	// STATIC ACCESS
+	// ------------------------------------
+
+	/**
+	* Loaded heightfield, creating it from the scene terrain on first use.
+	* Must be called from the main thread the first time, other threads should use Loaded.
+	*/
+	public static Heightfield Get(){
+		if (current == null) {
+			lock (loadLock) {
+				if (current == null) {
+					Terrain terrain = Terrain.activeTerrain;
+					if (terrain == null) terrain = GameObject.Find("Terrain").GetComponent<Terrain>();
+					current = new Heightfield(terrain);
+				}
+			}
+		}
+		return current;
+	}
+
+	/**
+	* Heightfield if it has been loaded already, null otherwise. Safe from any thread.
+	*/
+	public static Heightfield Loaded {
+		get { return current; }
+	}
+
+	/**
+	* Take a new snapshot (eg: after a terrain modification or a new level)
+	*/
+	public static Heightfield Reload(Terrain terrain){
+		lock (loadLock) {
+			current = new Heightfield(terrain);
+		}
+		return current;
+	}
+
+	public static void Unload(){
+		current = null;
+	}
+
+	// ------------------------------------
+	// SAMPLING
+	// ------------------------------------
+
+	public Rect Bounds {
+		get { return new Rect(origin.x, origin.z, size.x, size.z); }
+	}
+
+	/**
+	* Bilinear interpolated height in world units, positions outside the terrain are clamped
+	*/
+	public float Sample(float worldX, float worldZ){
+		float fx = Mathf.Clamp((worldX - origin.x) * invCellX, 0, width - 1);
+		float fz = Mathf.Clamp((worldZ - origin.z) * invCellZ, 0, depth - 1);
+
+		int x0 = (int) fx;
+		int z0 = (int) fz;
+		int x1 = x0 < width - 1 ? x0 + 1 : x0;
+		int z1 = z0 < depth - 1 ? z0 + 1 : z0;
+		float tx = fx - x0;
+		float tz = fz - z0;
+
+		int row0 = z0 * width;
+		int row1 = z1 * width;
+		float h0 = heights[row0 + x0] + (heights[row0 + x1] - heights[row0 + x0]) * tx;
+		float h1 = heights[row1 + x0] + (heights[row1 + x1] - heights[row1 + x0]) * tx;
+		return h0 + (h1 - h0) * tz;
+	}
+
+	public float Sample(Vector3 pos){
+		return Sample(pos.x, pos.z);
+	}
+
+	/**
+	* Same position with y on the terrain surface
+	*/
+	public Vector3 OnSurface(Vector3 pos){
+		return new Vector3(pos.x, Sample(pos.x, pos.z), pos.z);
+	}
+
+	/**
+	* Sample count positions at once, writing the heights in result
+	*/
+	public void SampleBatch(Vector3[] positions, float[] result, int count){
+		for (int i = 0; i < count; i++) result[i] = Sample(positions[i].x, positions[i].z);
+	}
+
+	/**
+	* Move count positions to the terrain surface in place
+	*/
+	public void SnapBatch(Vector3[] positions, int count){
+		for (int i = 0; i < count; i++) positions[i].y = Sample(positions[i].x, positions[i].z);
+	}
+
+	public void SnapBatch(List<Vector3> positions){
+		for (int i = 0; i < positions.Count; i++) positions[i] = OnSurface(positions[i]);
+	}
+}
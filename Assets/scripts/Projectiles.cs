@@ -0,0 +1,283 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Projectiles of the ranged attacks, without a GameObject per projectile.
+*
+* Projectiles are stored in flat arrays (position, velocity, target id, damage...) and advanced
+* all at once every tick (see Gameplay.LateUpdate): they home to their target, and hit the first enemy
+* unit of the target layer (ground or air) on their way, found with a SpatialHash of the units built
+* once per tick. Damage goes through Combat, so it's applied with the melee attacks of the frame.
+* The attack sound is played when the projectile is fired, hits have no sound.
+* All the projectiles are drawn as lines of a single mesh.
+*/
+public class Projectiles {
+
+	public const float MELEE_RANGE = 1; //Attacks with a longer range fire projectiles
+
+	private const float HIT_RADIUS = 0.2f; //Added to the radius of the units
+	private const float MAX_UNIT_RADIUS = 2; //Hash query radius
+	private const float LAUNCH_HEIGHT = 1;
+	private const float AIM_HEIGHT = 0.5f;
+	private const float TRAIL = 0.6f; //Length of the drawn line
+	private const float LIFETIME_MARGIN = 1; //Seconds after the expected flight time before expiring
+
+	private static int count = 0;
+	private static Vector3[] positions = new Vector3[256];
+	private static Vector3[] velocities = new Vector3[256];
+	private static Vector3[] aims = new Vector3[256]; //Last known position of the target
+	private static float[] speeds = new float[256];
+	private static float[] lifetimes = new float[256];
+	private static int[] targets = new int[256]; //Entity ids
+	private static int[] attackers = new int[256];
+	private static int[] owners = new int[256]; //Player ids of the attackers, see Teams
+	private static int[] damages = new int[256];
+	private static UnitType[] layers = new UnitType[256];
+
+	//Units of this tick
+	private static SpatialHash hash = new SpatialHash(MAX_UNIT_RADIUS);
+	private static Playable[] units = new Playable[256];
+	private static Vector2[] unitPositions = new Vector2[256];
+	private static int unitCount = 0;
+	private static int[] found = new int[32];
+
+	//Drawing
+	private static Mesh mesh;
+	private static Material material;
+	private static Vector3[] vertices = new Vector3[0];
+	private static int drawn = 0;
+
+	public static int hitsLastTick;
+	public static int expiredLastTick;
+
+	public static int Count {
+		get { return count; }
+	}
+
+	public static bool IsRanged(Attack attack){
+		return attack.range > MELEE_RANGE && attack.projectileSpeed > 0;
+	}
+
+	/**
+	* Fire a projectile from attacker to target, the damage is applied when it hits
+	*/
+	public static void Launch(Playable attacker, Playable target, int damage, Attack attack){
+		if (count == positions.Length) Grow();
+
+		Vector3 from = attacker.transform.position + Vector3.up * LAUNCH_HEIGHT;
+		Vector3 aim = target.transform.position + Vector3.up * AIM_HEIGHT;
+		positions[count] = from;
+		velocities[count] = (aim - from).normalized * attack.projectileSpeed;
+		aims[count] = aim;
+		speeds[count] = attack.projectileSpeed;
+		lifetimes[count] = (aim - from).magnitude / attack.projectileSpeed + LIFETIME_MARGIN;
+		targets[count] = target.id;
+		attackers[count] = attacker.id;
+		owners[count] = attacker.owner;
+		damages[count] = damage;
+		layers[count] = target.type;
+		count++;
+
+		AudioEvents.Play(attack.audio, attacker.transform.position, AudioEvents.PRIORITY_ATTACK);
+	}
+
+	// ------------------------------------
+	// STEP
+	// ------------------------------------
+
+	/**
+	* Move all the projectiles and queue the hits in Combat, call once per frame before Combat.Resolve
+	*/
+	public static void Step(float dt){
+		hitsLastTick = 0;
+		expiredLastTick = 0;
+		if (count > 0) {
+			BuildUnits();
+
+			int i = 0;
+			while (i < count) {
+				if (Advance(i, dt)) Remove(i); //The last one is moved to i
+				else i++;
+			}
+			for (int u = 0; u < unitCount; u++) units[u] = null;
+		}
+		Draw();
+	}
+
+	/**
+	* Move a projectile, returns true if it hit or expired
+	*/
+	private static bool Advance(int i, float dt){
+		Playable target = Entities.Get<Playable>(targets[i]);
+		if (target != null && target.life > 0) aims[i] = target.transform.position + Vector3.up * AIM_HEIGHT;
+
+		Vector3 to = aims[i] - positions[i];
+		float distance = to.magnitude;
+		float step = speeds[i] * dt;
+		bool arrived = distance <= step;
+		if (distance > 0) velocities[i] = to * (speeds[i] / distance);
+		positions[i] = arrived ? aims[i] : positions[i] + velocities[i] * dt;
+
+		Playable hit = HitTest(i, target);
+		if (hit != null) {
+			Combat.Attack(Entities.Get<Playable>(attackers[i]), hit, damages[i], null); //Sound played on launch
+			hitsLastTick++;
+			return true;
+		}
+
+		lifetimes[i] -= dt;
+		if (arrived || lifetimes[i] <= 0) {
+			expiredLastTick++; //Target gone or dodged
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	* The target if it's touched, else the closest enemy unit of the target layer touched.
+	* The target is tested on its own, so a crowd around it can't push it out of the query results
+	*/
+	private static Playable HitTest(int i, Playable target){
+		Vector2 center = new Vector2(positions[i].x, positions[i].z);
+		if (Touches(i, target, center)) return target;
+
+		int n = hash.Query(center, MAX_UNIT_RADIUS + HIT_RADIUS, found);
+		while (n == found.Length) { //Maybe truncated
+			found = new int[found.Length * 2];
+			n = hash.Query(center, MAX_UNIT_RADIUS + HIT_RADIUS, found);
+		}
+
+		Playable closest = null;
+		float closestDistance = float.MaxValue;
+		for (int f = 0; f < n; f++) {
+			Playable p = units[found[f]];
+			if (p == null || p.life <= 0 || p.type != layers[i] || !Teams.AreEnemies(owners[i], p.owner)) continue;
+
+			float distance = (unitPositions[found[f]] - center).magnitude;
+			if (distance > p.Radius() + HIT_RADIUS) continue;
+			if (distance < closestDistance) {
+				closest = p;
+				closestDistance = distance;
+			}
+		}
+		return closest;
+	}
+
+	/**
+	* True if target is a live enemy of the projectile's layer within its radius of center
+	*/
+	private static bool Touches(int i, Playable target, Vector2 center){
+		if (target == null || target.life <= 0 || target.type != layers[i] || !Teams.AreEnemies(owners[i], target.owner)) return false;
+		Vector3 pos = target.transform.position;
+		return (new Vector2(pos.x, pos.z) - center).magnitude <= target.Radius() + HIT_RADIUS;
+	}
+
+	/**
+	* Units and buildings of all the players in the hash
+	*/
+	private static void BuildUnits(){
+		unitCount = 0;
+		for (int player = 0; player < Teams.Count; player++) {
+			List<Playable> list = Teams.Units(player);
+			for (int u = 0; u < list.Count; u++) {
+				Playable p = list[u];
+				if (p.life <= 0) continue;
+				if (unitCount == units.Length) {
+					System.Array.Resize(ref units, units.Length * 2);
+					System.Array.Resize(ref unitPositions, units.Length);
+				}
+				Vector3 pos = p.transform.position;
+				units[unitCount] = p;
+				unitPositions[unitCount] = new Vector2(pos.x, pos.z);
+				unitCount++;
+			}
+		}
+		hash.Build(unitPositions, unitCount);
+	}
+
+	private static void Remove(int i){
+		count--;
+		positions[i] = positions[count];
+		velocities[i] = velocities[count];
+		aims[i] = aims[count];
+		speeds[i] = speeds[count];
+		lifetimes[i] = lifetimes[count];
+		targets[i] = targets[count];
+		attackers[i] = attackers[count];
+		owners[i] = owners[count];
+		damages[i] = damages[count];
+		layers[i] = layers[count];
+	}
+
+	private static void Grow(){
+		int size = positions.Length * 2;
+		System.Array.Resize(ref positions, size);
+		System.Array.Resize(ref velocities, size);
+		System.Array.Resize(ref aims, size);
+		System.Array.Resize(ref speeds, size);
+		System.Array.Resize(ref lifetimes, size);
+		System.Array.Resize(ref targets, size);
+		System.Array.Resize(ref attackers, size);
+		System.Array.Resize(ref owners, size);
+		System.Array.Resize(ref damages, size);
+		System.Array.Resize(ref layers, size);
+	}
+
+	// ------------------------------------
+	// DRAW
+	// ------------------------------------
+
+	/**
+	* A line per projectile, from its tail to its head. Unused lines are collapsed to a point
+	*/
+	private static void Draw(){
+		if (count == 0 && drawn == 0) return;
+		if (mesh == null) CreateMesh();
+		if (vertices.Length < count * 2) ResizeMesh(positions.Length);
+
+		for (int i = 0; i < count; i++) {
+			vertices[2 * i] = positions[i] - velocities[i].normalized * TRAIL;
+			vertices[2 * i + 1] = positions[i];
+		}
+		for (int v = count * 2; v < drawn * 2; v++) vertices[v] = Vector3.zero;
+		drawn = count;
+
+		mesh.vertices = vertices;
+		Graphics.DrawMesh(mesh, Matrix4x4.identity, material, 0);
+	}
+
+	private static void CreateMesh(){
+		mesh = new Mesh();
+		mesh.MarkDynamic();
+		material = new Material(Shader.Find("Sprites/Default"));
+		ResizeMesh(positions.Length);
+	}
+
+	private static void ResizeMesh(int projectiles){
+		vertices = new Vector3[projectiles * 2];
+		Color[] colors = new Color[vertices.Length];
+		int[] indices = new int[vertices.Length];
+		for (int v = 0; v < vertices.Length; v++) {
+			colors[v] = v % 2 == 0 ? new Color(1, 0.8f, 0.3f, 0) : new Color(1, 0.9f, 0.5f, 1);
+			indices[v] = v;
+		}
+		mesh.Clear();
+		mesh.vertices = vertices;
+		mesh.colors = colors;
+		mesh.SetIndices(indices, MeshTopology.Lines, 0);
+		mesh.bounds = new Bounds(Vector3.zero, Vector3.one * 100000); //Never culled
+		drawn = 0;
+	}
+
+	/**
+	* Called when the level is unloaded
+	*/
+	public static void Reset(){
+		count = 0;
+		if (mesh != null) Object.Destroy(mesh);
+		if (material != null) Object.Destroy(material);
+		mesh = null;
+		material = null;
+		drawn = 0;
+	}
+}
@@ -6,19 +6,39 @@ using System.Collections.Generic;
 public class ResearchManager {
 	public List<Research> inProgress = new List<Research>();
 	public List<Research> finished = new List<Research>();
+
+	//Researches in progress or finished can't be developed, see Research.CanBeDeveloped
+	[System.NonSerialized]
+	public TechTree techTree;
+
+	public ResearchManager() {}
+
+	public ResearchManager(TechTree techTree) {
+		this.techTree = techTree;
+	}
 	
 	public void StartDevelopment (Research r) {
 		Debug.Log ("Adding "+r.name+ " to inProgress " +inProgress);
 		inProgress.Add(r);
+		Changed();
 	}
 	public void FinishDevelopment(Research r) {
 		Debug.Log ("Finished research "+r.name);
 		
 		inProgress.Remove(r);
 		finished.Add(r);
+		Changed();
 	}
 	public void CancelDevelopment (Research r) {
 		inProgress.Remove(r);
+		Changed();
+	}
+
+	/**
+	* Lists modified directly (see Player.Load)
+	*/
+	public void Changed() {
+		if (techTree != null) techTree.Changed();
 	}
 	
 	public bool Researched(Research.Available research) {
@@ -9,13 +9,37 @@ public class Resource : MonoBehaviour {
 
 	public float SPEED_COLLECTION = 0.25f; //in seconds
 
+	public int id { get; private set; } //See Entities (not a field, so CopyComponent doesn't copy it)
+
+	public void Register(){
+		if (id == 0) id = Entities.Register(this);
+	}
+
+	void OnDestroy(){
+		Entities.Unregister(id);
+	}
+
+	/**
+	* Register the resources of the scene sorted by position, so they get the same ids every game
+	*/
+	public static void RegisterAll(){
+		GameObject[] gos = GameObject.FindGameObjectsWithTag("Resource");
+		System.Array.Sort(gos, delegate(GameObject a, GameObject b) {
+			Vector3 pa = a.transform.position;
+			Vector3 pb = b.transform.position;
+			return pa.x != pb.x ? pa.x.CompareTo(pb.x) : pa.z.CompareTo(pb.z);
+		});
+		foreach (GameObject go in gos) {
+			Resource r = go.GetComponent<Resource>();
+			if (r != null) r.Register();
+		}
+	}
+
 	void OnMouseOver () {
 
 		if (Controller.RightClickOrTouch()) {
-			foreach (Unit u in Unit.Selected<Unit>()) {
-				Debug.Log ("Unit " + u.name+ " will collect "+this);
-				if (u is Worker) ((Worker) u).Collect(this);
-			}
+			Register();
+			CommandStream.Issue(Command.Collect(Unit.Selected<Worker>(), this));
 		}
 	}
 	
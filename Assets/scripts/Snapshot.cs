@@ -0,0 +1,328 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.IO;
+using System;
+
+/**
+* Binary snapshot of a match: players, units, buildings and resources.
+*
+* Quick save: F5, quick load: F9
+* Start from a saved file: game -snapshot match.snap (eg: benchmarks starting in the middle of a game)
+*
+* Restoring reuses the entities that still exist with the same id and type, and only creates or
+* destroys the others. Orders (targets, harvest, building and training queues) are given on the
+* next frame, once the new entities have started.
+*/
+public class Snapshot {
+
+	private const int MAGIC = 0x50414E53; //SNAP
+	private const int VERSION = 1;
+
+	private const byte UNIT = 0;
+	private const byte WORKER = 1;
+	private const byte BUILDING = 2;
+
+	private static byte[] quickSave;
+	private static string startFile;
+
+	private static List<Orders> pending = new List<Orders>();
+	private static int restoreFrame;
+
+	/**
+	* Orders of a restored entity, given once it has started
+	*/
+	private class Orders {
+		public Playable entity;
+		public int target;
+		public int resource;
+		public int build;
+		public List<string> queue;
+		public float elapsed;
+	}
+
+	// ------------------------------------
+	// GAME LOOP
+	// ------------------------------------
+
+	/**
+	* Read the command line, call on game start
+	*/
+	public static void Start(){
+		quickSave = null;
+		startFile = null;
+		pending.Clear();
+
+		string[] args = Environment.GetCommandLineArgs();
+		for (int i = 0; i < args.Length - 1; i++) {
+			if (args[i] == "-snapshot") startFile = args[i+1];
+		}
+	}
+
+	/**
+	* Quick save keys and pending restores, call once per frame
+	*/
+	public static void Tick(){
+		if (startFile != null) {
+			LoadFile(startFile);
+			startFile = null;
+		} else if (pending.Count > 0 && Time.frameCount > restoreFrame) GiveOrders();
+
+		if (Input.GetKeyDown(KeyCode.F5)) {
+			quickSave = Save();
+			Debug.Log ("Quick save " + quickSave.Length + " bytes");
+		}
+		if (Input.GetKeyDown(KeyCode.F9) && quickSave != null) Restore(quickSave);
+	}
+
+	public static void SaveFile(string path){
+		File.WriteAllBytes(path, Save());
+	}
+
+	public static void LoadFile(string path){
+		Debug.Log ("Restoring snapshot " + path);
+		Restore(File.ReadAllBytes(path));
+	}
+
+	// ------------------------------------
+	// SAVE
+	// ------------------------------------
+
+	public static byte[] Save(){
+		List<Resource> resources = new List<Resource>();
+		List<Playable> playables = new List<Playable>();
+		foreach (MonoBehaviour entity in Entities.All) {
+			if (entity == null) continue;
+			if (entity is Resource) resources.Add((Resource) entity);
+			else if (entity is Playable && ((Playable) entity).life > 0) playables.Add((Playable) entity);
+		}
+
+		MemoryStream stream = new MemoryStream();
+		using (BinaryWriter writer = new BinaryWriter(stream)) {
+			writer.Write(MAGIC);
+			writer.Write(VERSION);
+			writer.Write(CommandStream.tick);
+			writer.Write(Entities.NextId);
+
+			writer.Write(resources.Count);
+			foreach (Resource r in resources) {
+				writer.Write(r.id);
+				writer.Write(r.quantity);
+			}
+
+			writer.Write(playables.Count);
+			foreach (Playable p in playables) Write(writer, p);
+
+			Player[] players = { Gameplay.player1, Gameplay.player2 };
+			writer.Write(players.Length);
+			foreach (Player player in players) {
+				writer.Write(player.PLAYER_TAG);
+				player.Save(writer);
+			}
+		}
+		return stream.ToArray();
+	}
+
+	private static void Write(BinaryWriter writer, Playable p){
+		Worker worker = p as Worker;
+		Building building = p as Building;
+		writer.Write(building != null ? BUILDING : worker != null ? WORKER : UNIT);
+
+		writer.Write(p.id);
+		writer.Write(TemplateName(p.name));
+		writer.Write(p.tag);
+		Vector3 pos = p.transform.position;
+		writer.Write(pos.x);
+		writer.Write(pos.y);
+		writer.Write(pos.z);
+		writer.Write(p.transform.eulerAngles.y);
+		writer.Write(p.life);
+		writer.Write(p.target != null ? p.target.id : 0);
+
+		if (worker != null) {
+			writer.Write(worker.carried);
+			writer.Write(worker.carriedType);
+			writer.Write(worker.resource != null ? worker.resource.id : 0);
+			writer.Write(worker.Constructing != null ? worker.Constructing.id : 0);
+		} else if (building != null) {
+			writer.Write(!building.isBuilding);
+			writer.Write(building.BuildingProgress);
+			List<StrategyObject> queue = building.trainingQueue ?? new List<StrategyObject>();
+			writer.Write(queue.Count);
+			foreach (StrategyObject s in queue) writer.Write(s.name);
+			writer.Write(queue.Count > 0 ? building.TrainingElapsed : 0);
+		}
+	}
+
+	// ------------------------------------
+	// RESTORE
+	// ------------------------------------
+
+	public static void Restore(byte[] snapshot){
+		using (BinaryReader reader = new BinaryReader(new MemoryStream(snapshot))) {
+			if (reader.ReadInt32() != MAGIC) throw new InvalidDataException("Not a snapshot");
+			int version = reader.ReadInt32();
+			if (version != VERSION) throw new InvalidDataException("Unsupported snapshot version " + version);
+			int tick = reader.ReadInt32();
+			int nextId = reader.ReadInt32();
+
+			//Current entities, the ones left at the end are not in the snapshot
+			Dictionary<int, MonoBehaviour> existing = new Dictionary<int, MonoBehaviour>();
+			foreach (MonoBehaviour entity in Entities.All) if (entity != null) existing[Id(entity)] = entity;
+
+			int resources = reader.ReadInt32();
+			for (int i = 0; i < resources; i++) {
+				int id = reader.ReadInt32();
+				int quantity = reader.ReadInt32();
+				Resource r = Entities.Get<Resource>(id);
+				if (r != null) r.quantity = quantity;
+				else Debug.LogWarning("Snapshot resource " + id + " not found");
+				existing.Remove(id);
+			}
+
+			pending.Clear();
+			int playables = reader.ReadInt32();
+			for (int i = 0; i < playables; i++) {
+				Orders orders = Read(reader, existing);
+				if (orders != null) pending.Add(orders);
+			}
+
+			foreach (MonoBehaviour entity in existing.Values) Remove(entity);
+			Entities.NextId = Mathf.Max(Entities.NextId, nextId);
+
+			int players = reader.ReadInt32();
+			for (int i = 0; i < players; i++) {
+				string tag = reader.ReadString();
+				Player player = Gameplay.getPlayer(tag);
+				if (player == null) throw new InvalidDataException("Snapshot player " + tag + " not found");
+				player.Load(reader);
+			}
+
+			restoreFrame = Time.frameCount;
+			Debug.Log ("Restored snapshot of tick " + tick + ": " + resources + " resources, " + playables + " units and buildings");
+		}
+	}
+
+	private static Orders Read(BinaryReader reader, Dictionary<int, MonoBehaviour> existing){
+		byte kind = reader.ReadByte();
+		int id = reader.ReadInt32();
+		string template = reader.ReadString();
+		string tag = reader.ReadString();
+		Vector3 position = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle());
+		float rotation = reader.ReadSingle();
+		int life = reader.ReadInt32();
+
+		Orders orders = new Orders();
+		orders.target = reader.ReadInt32();
+
+		int carried = 0, carriedType = 0;
+		bool finished = true;
+		float progress = 0;
+		if (kind == WORKER) {
+			carried = reader.ReadInt32();
+			carriedType = reader.ReadInt32();
+			orders.resource = reader.ReadInt32();
+			orders.build = reader.ReadInt32();
+		} else if (kind == BUILDING) {
+			finished = reader.ReadBoolean();
+			progress = reader.ReadSingle();
+			int count = reader.ReadInt32();
+			orders.queue = new List<string>(count);
+			for (int q = 0; q < count; q++) orders.queue.Add(reader.ReadString());
+			orders.elapsed = reader.ReadSingle();
+		}
+
+		//Reuse the entity if it's the same one
+		MonoBehaviour current;
+		Playable p = null;
+		if (existing.TryGetValue(id, out current)) {
+			p = current as Playable;
+			bool same = p != null && p.tag == tag && TemplateName(p.name) == template;
+			if (same && kind == BUILDING) same = ((Building) p).isBuilding == !finished;
+			if (same) existing.Remove(id);
+			else p = null;
+		}
+
+		if (p == null) {
+			if (current != null) {
+				Remove(current);
+				existing.Remove(id);
+			}
+			Playable templateObject = kind == BUILDING ? Templates.Get<Building>(template) : Templates.Get<Playable>(template);
+			if (templateObject == null) {
+				Debug.LogWarning("Snapshot template " + template + " not found");
+				return null;
+			}
+			if (kind == BUILDING) p = Building.Restore((Building) templateObject, position, tag, id, finished, progress);
+			else p = Playable.createWithId(templateObject, position, tag, id);
+		} else {
+			p.CancelActions();
+			if (kind == BUILDING) {
+				((Building) p).BuildingProgress = progress;
+				((Building) p).ClearTraining(); //Restored with the orders
+			}
+		}
+
+		p.transform.position = position;
+		p.transform.eulerAngles = new Vector3(0, rotation, 0);
+		p.life = life;
+		Entities.MarkChanged(p);
+		if (kind == WORKER) {
+			((Worker) p).carried = carried;
+			((Worker) p).carriedType = carriedType;
+		}
+
+		orders.entity = p;
+		return orders;
+	}
+
+	/**
+	* Remove an entity that is not in the snapshot, without death effects
+	*/
+	private static void Remove(MonoBehaviour entity){
+		Playable p = entity as Playable;
+		if (p != null) {
+			p.LeaveTechTree();
+			Entities.Unregister(p.id);
+			p.id = 0; //Its id can be given to a restored entity
+		} else Entities.Unregister(Id(entity));
+		UnityEngine.Object.Destroy(entity.gameObject);
+	}
+
+	private static int Id(MonoBehaviour entity){
+		return entity is Resource ? ((Resource) entity).id : ((Playable) entity).id;
+	}
+
+	private static void GiveOrders(){
+		foreach (Orders o in pending) {
+			Playable p = o.entity;
+			if (p == null) continue;
+
+			Playable target = Entities.Get<Playable>(o.target);
+			if (target != null) p.Attack(target);
+
+			Worker worker = p as Worker;
+			if (worker != null) {
+				Building build = Entities.Get<Building>(o.build);
+				Resource resource = Entities.Get<Resource>(o.resource);
+				if (build != null) worker.Build(build);
+				else if (resource != null) worker.Collect(resource);
+			}
+
+			Building building = p as Building;
+			if (building != null && o.queue != null) {
+				List<StrategyObject> queue = new List<StrategyObject>();
+				foreach (string name in o.queue) {
+					StrategyObject s = building.Developable(name);
+					if (s != null) queue.Add(s);
+				}
+				building.RestoreTraining(queue, o.elapsed);
+			}
+		}
+		pending.Clear();
+	}
+
+	private static string TemplateName(string name){
+		int clone = name.IndexOf("(Clone)");
+		return clone >= 0 ? name.Substring(0, clone) : name;
+	}
+}
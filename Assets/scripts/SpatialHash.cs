@@ -0,0 +1,105 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Spatial hash of points on the XZ plane, rebuilt in one pass every tick (counting sort by bucket).
+* Items are indices into the positions array given to Build. No allocations after the first builds.
+* Queries are safe from several threads once built.
+*/
+public class SpatialHash {
+
+	private const int MIN_BUCKETS = 64;
+
+	private readonly float invCellSize;
+
+	private int buckets;
+	private int[] bucketStart = new int[0]; //buckets + 1, items of bucket b are entries[bucketStart[b]..bucketStart[b+1]]
+	private int[] entries = new int[0];
+	private int[] itemBucket = new int[0];
+	private int[] cursors = new int[0];
+	private Vector2[] positions;
+	private int count;
+
+	public SpatialHash(float cellSize){
+		invCellSize = 1 / cellSize;
+	}
+
+	public int Count {
+		get { return count; }
+	}
+
+	public void Build(Vector2[] positions, int count){
+		this.positions = positions;
+		this.count = count;
+
+		int wanted = Mathf.Max(MIN_BUCKETS, Mathf.NextPowerOfTwo(count * 2));
+		if (wanted != buckets) {
+			buckets = wanted;
+			bucketStart = new int[buckets + 1];
+		}
+		if (entries.Length < count) {
+			entries = new int[Mathf.NextPowerOfTwo(count)];
+			itemBucket = new int[entries.Length];
+		}
+
+		System.Array.Clear(bucketStart, 0, bucketStart.Length);
+		for (int i = 0; i < count; i++) {
+			int b = Bucket(Cell(positions[i].x), Cell(positions[i].y));
+			itemBucket[i] = b;
+			bucketStart[b + 1]++;
+		}
+		for (int b = 0; b < buckets; b++) bucketStart[b + 1] += bucketStart[b];
+
+		if (cursors.Length < buckets) cursors = new int[buckets];
+		System.Array.Copy(bucketStart, cursors, buckets);
+		for (int i = 0; i < count; i++) entries[cursors[itemBucket[i]]++] = i;
+	}
+
+	/**
+	* Items within radius of center, written in result.
+	* Returns the number of items found, at most result.Length
+	*/
+	public int Query(Vector2 center, float radius, int[] result){
+		int found = 0;
+		float radiusSqr = radius * radius;
+		int minX = Cell(center.x - radius), maxX = Cell(center.x + radius);
+		int minZ = Cell(center.y - radius), maxZ = Cell(center.y + radius);
+
+		for (int z = minZ; z <= maxZ; z++) {
+			for (int x = minX; x <= maxX; x++) {
+				int b = Bucket(x, z);
+				if (Visited(b, minX, maxX, minZ, x, z)) continue;
+
+				for (int e = bucketStart[b]; e < bucketStart[b + 1]; e++) {
+					int i = entries[e];
+					//Different cells can share a bucket, the distance check filters them
+					if ((positions[i] - center).sqrMagnitude > radiusSqr) continue;
+					if (found == result.Length) return found;
+					result[found++] = i;
+				}
+			}
+		}
+		return found;
+	}
+
+	/**
+	* True if a previous cell of the query (in scan order) has the same bucket
+	*/
+	private bool Visited(int bucket, int minX, int maxX, int minZ, int cx, int cz){
+		for (int z = minZ; z <= cz; z++) {
+			int lastX = z < cz ? maxX : cx - 1;
+			for (int x = minX; x <= lastX; x++) {
+				if (Bucket(x, z) == bucket) return true;
+			}
+		}
+		return false;
+	}
+
+	private int Cell(float v){
+		return Mathf.FloorToInt(v * invCellSize);
+	}
+
+	private int Bucket(int x, int z){
+		return ((x * 73856093) ^ (z * 19349663)) & (buckets - 1);
+	}
+}
@@ -0,0 +1,44 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Unit, building and research templates by name, for the code that creates objects from a name
+* (commands, snapshots and the developable objects of the buildings).
+* GameObject.Find only sees active objects, templates are also found while inactive. They are cached once found
+*/
+public class Templates {
+
+	private static Dictionary<string, StrategyObject> templates = new Dictionary<string, StrategyObject>();
+
+	/**
+	* Template with the given name, null if there is none or it's not a T
+	*/
+	public static T Get<T>(string name) where T : StrategyObject {
+		StrategyObject template;
+		if (!templates.TryGetValue(name, out template) || template == null) {
+			template = Find(name);
+			if (template == null) return null;
+			templates[name] = template;
+		}
+		return template as T;
+	}
+
+	private static StrategyObject Find(string name){
+		GameObject go = GameObject.Find(name);
+		StrategyObject template = go != null ? go.GetComponent<StrategyObject>() : null;
+		if (template != null) return template;
+
+		//Inactive objects too
+		foreach (StrategyObject s in Resources.FindObjectsOfTypeAll<StrategyObject>()) {
+			if (s.name == name) return s;
+		}
+		return null;
+	}
+
+	/**
+	* Called when the level is unloaded
+	*/
+	public static void Reset(){
+		templates.Clear();
+	}
+}
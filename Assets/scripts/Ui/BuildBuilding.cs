@@ -33,16 +33,32 @@ public class BuildBuilding : MonoBehaviour {
 	void OnClick(){
 		Debug.Log("Button click");
 		
-		if(Gameplay.player1.consumeResources(building.cost)) {
+		//Resources are consumed when the building is placed (see CommandStream)
+		if(Gameplay.player1.hasResources(building.cost)) {
+			if (Gui.buildingSelected != null) Destroy(Gui.buildingSelected.gameObject);
 			Gui.buildingSelected =  Building.BuildPlace(building);
+			Gui.buildingTemplate = building;
 		} else {
 			Utils.PlayAudioOnCamera(Gameplay.st.notEnoughResource1);
 			Debug.Log("Not enough minerals to build " + building.name);
 		}
 			//else audioNotMinerals.Play();
 	}
+	/**
+	* Only waits for the player, then the button is refreshed when the tech tree changes
+	*/
 	void Update(){
-		//Debug.Log ("Update ");
+		if (Gameplay.player1 == null) return;
+		Gameplay.player1.techTree.changed += Refresh;
+		Refresh();
+		enabled = false;
+	}
+
+	void Refresh(){
 		button.interactable = building.CanBeDeveloped();
 	}
+
+	void OnDestroy(){
+		if (Gameplay.player1 != null) Gameplay.player1.techTree.changed -= Refresh;
+	}
 }
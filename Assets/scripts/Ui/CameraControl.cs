@@ -45,12 +45,7 @@ public class CameraControl : MonoBehaviour {
 	}
 
 	public static Vector3 minimapMousePosition(){
-		Camera minimap = GameObject.Find("Minimap").GetComponent<Camera>();
-		
-		Ray ray = minimap.ScreenPointToRay(Input.mousePosition);
-		RaycastHit hit ;
-		Physics.Raycast(ray, out hit);
-		return hit.point;
+		return Minimap.ScreenToWorld(Input.mousePosition);
 	}
 	
 	public void Zoom(){		
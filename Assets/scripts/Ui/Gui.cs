@@ -7,52 +7,70 @@ public class Gui : MonoBehaviour {
 	public Building[] buildings;
 	
 	public static Building buildingSelected; 
+	public static Building buildingTemplate;
 
-	private Text gasTotal;
-	private Text supplyTotal;
-	private Text crystalTotal;
+	private Hud.Binding gasTotal;
+	private Hud.Binding supplyTotal;
+	private Hud.Binding crystalTotal;
+	private Player bound;
 
 	public void Start(){
 		
 		GameObject[] bo = GameObject.FindGameObjectsWithTag("Building");
-		gasTotal = GameObject.Find("GasTotal").GetComponent<Text>();
-		crystalTotal = GameObject.Find("CrystalTotal").GetComponent<Text>();
-		supplyTotal = GameObject.Find("SupplyTotal").GetComponent<Text>();
+		gasTotal = new Hud.Binding(GameObject.Find("GasTotal").GetComponent<Text>());
+		crystalTotal = new Hud.Binding(GameObject.Find("CrystalTotal").GetComponent<Text>());
+		supplyTotal = new Hud.Binding(GameObject.Find("SupplyTotal").GetComponent<Text>());
 		
 		buildings = new Building[bo.Length];
 		
 		for (int i = 0; i < bo.Length; i++){
 			buildings[i] = bo[i].GetComponent<Building>();
 		}
-
-		InvokeRepeating("UpdateResources", 0, 1);
 	}
 
+	/**
+	* Called when the resources or supply of the player change
+	*/
 	void UpdateResources()  {
 	
-		crystalTotal.text = Gameplay.player1.resources[0].ToString();
-		gasTotal.text = Gameplay.player1.resources[1].ToString();
-		supplyTotal.text = Gameplay.player1.totalSupply +"/"+ Gameplay.player1.maxSupply;
+		crystalTotal.Set(Hud.Int(Gameplay.player1.resources[0]));
+		gasTotal.Set(Hud.Int(Gameplay.player1.resources[1]));
+		supplyTotal.Set(Hud.Pair(Gameplay.player1.totalSupply, Gameplay.player1.maxSupply));
 		
 	}
 	void Update(){
+		//Bind once the player exists
+		if (bound != Gameplay.player1 && Gameplay.player1 != null) {
+			bound = Gameplay.player1;
+			bound.changed += UpdateResources;
+			UpdateResources();
+		}
 		if (buildingSelected != null) drawWireframeBuilding();
 	}
 
+	void OnDestroy(){
+		if (bound != null) bound.changed -= UpdateResources;
+	}
+
+	void OnGUI(){
+		Minimap.Draw();
+	}
+
 	void drawWireframeBuilding(){
 		Vector3 position = Utils.screen2world(Input.mousePosition);
-		position.y = Terrain.activeTerrain.SampleHeight(position) + 0.1f;
+		position.y = Heightfield.Get().Sample(position) + 0.1f;
 		buildingSelected.transform.position = position ;
 		if (Input.GetMouseButtonDown(0)){
 			if (!buildingSelected.canBuild){
 				Utils.PlayAudioOnCamera(Gameplay.st.cantBuildHere);
 			} else {
-				buildingSelected.BuildStart ();
+				Worker w = Playable.Selected<Worker>()[0];
+				CommandStream.Issue(Command.Place(w, buildingTemplate, buildingSelected.transform.position));
+				if (buildingSelected != null) Destroy(buildingSelected.gameObject); //Not placed
 				buildingSelected = null;
 			}	
 		}
 		if (Input.GetMouseButtonDown(1)){
-			Gameplay.player1.addResources(buildingSelected.cost);
 			Destroy(buildingSelected.gameObject);
 			buildingSelected = null;
 		}
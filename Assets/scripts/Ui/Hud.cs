@@ -0,0 +1,122 @@
+using UnityEngine;
+using System.Collections.Generic;
+using UnityEngine.UI;
+
+/**
+* Strings for the HUD texts without garbage: every number or label is formatted once in a char
+* buffer and cached, and a Binding only assigns the text when it changes.
+* The caches of pairs, clocks and labels are emptied when they reach MAX_CACHED strings.
+*/
+public class Hud {
+
+	private const int CACHED_INTS = 4096;
+	private const int MAX_CACHED = 1024; //Per dictionary
+
+	private static string[] ints = new string[CACHED_INTS];
+	private static Dictionary<long, string> pairs = new Dictionary<long, string>();
+	private static Dictionary<int, string> clocks = new Dictionary<int, string>();
+	private static Dictionary<string, Dictionary<int, string>> labels = new Dictionary<string, Dictionary<int, string>>();
+
+	private static char[] buffer = new char[64];
+
+	/**
+	* Text component that is only updated when the string changes
+	*/
+	public class Binding {
+		private readonly Text text;
+		private string last;
+
+		public Binding(Text text){
+			this.text = text;
+		}
+
+		public void Set(string value){
+			if (object.ReferenceEquals(value, last)) return;
+			last = value;
+			text.text = value;
+		}
+	}
+
+	// ------------------------------------
+	// CACHED STRINGS
+	// ------------------------------------
+
+	public static string Int(int value){
+		if (value < 0 || value >= CACHED_INTS) return value.ToString();
+		if (ints[value] == null) {
+			int length = Append(0, value, 1);
+			ints[value] = new string(buffer, 0, length);
+		}
+		return ints[value];
+	}
+
+	/**
+	* "a/b" (eg: supply)
+	*/
+	public static string Pair(int a, int b){
+		long key = ((long) a << 32) | (uint) b;
+		string s;
+		if (!pairs.TryGetValue(key, out s)) {
+			int length = Append(0, a, 1);
+			buffer[length++] = '/';
+			length = Append(length, b, 1);
+			s = new string(buffer, 0, length);
+			if (pairs.Count >= MAX_CACHED) pairs.Clear();
+			pairs.Add(key, s);
+		}
+		return s;
+	}
+
+	/**
+	* "mm:ss" with the given separator
+	*/
+	public static string Clock(int seconds, char separator){
+		int key = seconds * 256 + separator;
+		string s;
+		if (!clocks.TryGetValue(key, out s)) {
+			int length = Append(0, seconds / 60, 2);
+			buffer[length++] = separator;
+			length = Append(length, seconds % 60, 2);
+			s = new string(buffer, 0, length);
+			if (clocks.Count >= MAX_CACHED) clocks.Clear();
+			clocks.Add(key, s);
+		}
+		return s;
+	}
+
+	/**
+	* prefix followed by value (eg: "Defeat 5")
+	*/
+	public static string Label(string prefix, int value){
+		Dictionary<int, string> cache;
+		if (!labels.TryGetValue(prefix, out cache)) {
+			if (labels.Count >= MAX_CACHED) labels.Clear();
+			cache = new Dictionary<int, string>();
+			labels.Add(prefix, cache);
+		}
+		string s;
+		if (!cache.TryGetValue(value, out s)) {
+			s = prefix + Int(value);
+			if (cache.Count >= MAX_CACHED) cache.Clear();
+			cache.Add(value, s);
+		}
+		return s;
+	}
+
+	/**
+	* Write value at position of the buffer with at least digits digits (zero filled), returns the new length
+	*/
+	private static int Append(int position, int value, int digits){
+		if (value < 0) {
+			buffer[position++] = '-';
+			value = -value;
+		}
+		int start = position;
+		do {
+			buffer[position++] = (char) ('0' + value % 10);
+			value /= 10;
+		} while (value > 0 || position - start < digits);
+		System.Array.Reverse(buffer, start, position - start);
+		return position;
+	}
+}
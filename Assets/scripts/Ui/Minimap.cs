@@ -0,0 +1,175 @@
+using UnityEngine;
+using System.Threading;
+
+/**
+* Minimap drawn from the game state instead of a second camera rendering the scene.
+*
+* A few times per second the entity positions and the fog of the player are copied on the main
+* thread, then rasterized on a worker thread (see MinimapRaster) and uploaded to a small texture.
+* It's drawn where the "Minimap" camera of the scene was, and clicks are mapped directly to the
+* map coordinates.
+*/
+public class Minimap {
+
+	public const int SIZE = 128;
+
+	public static float refreshRate = 4; //Per second
+	public static bool threaded = true;
+
+	private static readonly Color32 PLAYER = new Color32(40, 230, 40, 255);
+	private static readonly Color32 ENEMY = new Color32(230, 40, 40, 255);
+	private static readonly Color32 RESOURCE = new Color32(90, 200, 255, 255);
+
+	private static MinimapRaster raster;
+	private static Texture2D texture; //Created on the first upload
+	private static Color32[] pixels;
+	private static MinimapRaster.Dot[] dots = new MinimapRaster.Dot[256];
+	private static int dotCount;
+	private static uint[] fog;
+	private static int fogWidth, fogDepth;
+
+	private static volatile bool rendering = false;
+	private static volatile bool ready = false;
+	private static float lastRefresh = float.MinValue;
+
+	private static Camera camera;
+
+	// ------------------------------------
+	// UPDATE
+	// ------------------------------------
+
+	/**
+	* Upload finished rasters and start new ones at refreshRate, call once per frame
+	*/
+	public static void Update(){
+		if (raster == null) Init();
+
+		if (ready) {
+			if (texture == null) {
+				texture = new Texture2D(SIZE, SIZE, TextureFormat.RGBA32, false);
+				texture.filterMode = FilterMode.Point;
+				texture.wrapMode = TextureWrapMode.Clamp;
+			}
+			texture.SetPixels32(pixels);
+			texture.Apply(false);
+			ready = false;
+		}
+
+		if (rendering || lastRefresh + 1 / refreshRate > Time.time) return;
+		lastRefresh = Time.time;
+
+		Gather();
+		rendering = true;
+		if (threaded) ThreadPool.QueueUserWorkItem(delegate (object state) { Render(); });
+		else Render();
+	}
+
+	private static void Init(){
+		raster = new MinimapRaster(SIZE, SIZE, Heightfield.Get().Bounds, Heightfield.Get().Sample);
+		pixels = new Color32[SIZE * SIZE];
+
+		//The scene camera is only kept for its position on the screen
+		GameObject go = GameObject.Find("Minimap");
+		if (go != null) {
+			camera = go.GetComponent<Camera>();
+			camera.enabled = false;
+		}
+	}
+
+	/**
+	* Copy what the raster needs, the game state is not touched from the worker thread
+	*/
+	private static void Gather(){
+		int player = Gameplay.player1.id;
+		Visibility visibility = Visibility.Get();
+
+		dotCount = 0;
+		foreach (MonoBehaviour entity in Entities.All) {
+			if (entity == null) continue;
+			Vector3 pos = entity.transform.position;
+
+			MinimapRaster.Dot dot = new MinimapRaster.Dot();
+			dot.x = pos.x;
+			dot.z = pos.z;
+			if (entity is Resource) {
+				dot.color = RESOURCE;
+				dot.size = 2;
+			} else {
+				bool own = ((Playable) entity).owner == player;
+				if (!own && !visibility.IsVisible(player, pos)) continue;
+				dot.color = own ? PLAYER : ENEMY;
+				dot.size = entity is Building ? 4 : 2;
+			}
+
+			if (dotCount == dots.Length) System.Array.Resize(ref dots, dots.Length * 2);
+			dots[dotCount++] = dot;
+		}
+
+		uint[] bits = visibility.Bits(player);
+		if (bits == null) fog = null;
+		else {
+			if (fog == null || fog.Length != bits.Length) fog = new uint[bits.Length];
+			System.Array.Copy(bits, fog, bits.Length);
+			fogWidth = visibility.width;
+			fogDepth = visibility.depth;
+		}
+	}
+
+	private static void Render(){
+		try {
+			raster.Render(pixels, dots, dotCount, fog, fogWidth, fogDepth, Visibility.CELL_SIZE);
+			ready = true;
+		} catch (System.Exception e) {
+			Debug.LogError("Minimap raster failed " + e);
+		}
+		rendering = false;
+	}
+
+	// ------------------------------------
+	// DRAW AND CONTROLS
+	// ------------------------------------
+
+	/**
+	* Minimap rectangle in screen coordinates (origin bottom left)
+	*/
+	public static Rect ScreenRect(){
+		if (camera == null) return new Rect(0, 0, 0, 0);
+		return camera.pixelRect;
+	}
+
+	public static bool Contains(Vector2 screen){
+		return ScreenRect().Contains(screen);
+	}
+
+	/**
+	* Position in the map of a screen point over the minimap, on the terrain surface
+	*/
+	public static Vector3 ScreenToWorld(Vector2 screen){
+		if (raster == null) Init();
+		Rect r = ScreenRect();
+		Vector2 uv = new Vector2((screen.x - r.xMin) / r.width, (screen.y - r.yMin) / r.height);
+		Vector2 world = raster.NormalizedToWorld(uv);
+		return Heightfield.Get().OnSurface(new Vector3(world.x, 0, world.y));
+	}
+
+	/**
+	* Call from OnGUI
+	*/
+	public static void Draw(){
+		if (texture == null || camera == null) return;
+		Rect r = ScreenRect();
+		//GUI coordinates start at the top left
+		GUI.DrawTexture(new Rect(r.xMin, Screen.height - r.yMax, r.width, r.height), texture);
+	}
+
+	public static void Reset(){
+		//A render in progress is discarded
+		if (texture != null) Object.Destroy(texture);
+		raster = null;
+		texture = null;
+		camera = null;
+		fog = null;
+		ready = false;
+		lastRefresh = float.MinValue;
+	}
+}
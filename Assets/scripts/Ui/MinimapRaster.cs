@@ -0,0 +1,138 @@
+using UnityEngine;
+
+/**
+* Software rasterizer of the minimap: terrain shaded by height, darkened where the player
+* has no vision, and a dot per entity.
+*
+* Only plain data (no Unity objects), so it can run on a worker thread and without a scene (see MinimapRasterCheck).
+* Pixel (0,0) is the bottom left corner, the min x and z of the area.
+*/
+public class MinimapRaster {
+
+	public delegate float HeightSampler(float x, float z);
+
+	public struct Dot {
+		public float x;
+		public float z;
+		public Color32 color;
+		public int size; //In pixels
+	}
+
+	private static readonly Color32 LOW = new Color32(52, 84, 38, 255);
+	private static readonly Color32 HIGH = new Color32(150, 132, 92, 255);
+
+	public readonly int width;
+	public readonly int height;
+	private readonly Rect area;
+	private readonly HeightSampler sampler;
+
+	private Color32[] terrain; //Rasterized once, on the first Render
+	private int[] fogCells;
+	private int fogWidth = -1;
+
+	public MinimapRaster(int width, int height, Rect area, HeightSampler sampler){
+		this.width = width;
+		this.height = height;
+		this.area = area;
+		this.sampler = sampler;
+	}
+
+	// ------------------------------------
+	// COORDINATES
+	// ------------------------------------
+
+	public Vector2 PixelToWorld(float px, float py){
+		return new Vector2(area.xMin + px * area.width / width, area.yMin + py * area.height / height);
+	}
+
+	/**
+	* Position in the map of a normalized point (0..1) of the minimap
+	*/
+	public Vector2 NormalizedToWorld(Vector2 uv){
+		return new Vector2(area.xMin + uv.x * area.width, area.yMin + uv.y * area.height);
+	}
+
+	private int PixelX(float x){
+		return (int) ((x - area.xMin) * width / area.width);
+	}
+
+	private int PixelY(float z){
+		return (int) ((z - area.yMin) * height / area.height);
+	}
+
+	// ------------------------------------
+	// RASTER
+	// ------------------------------------
+
+	/**
+	* Draw the minimap in target (width * height).
+	* fog: packed visibility bits of a grid of fogWidth x fogDepth cells of cellSize over the same area (see Visibility.Bits), null for no fog
+	*/
+	public void Render(Color32[] target, Dot[] dots, int count, uint[] fog, int fogWidth, int fogDepth, float cellSize){
+		if (terrain == null) RasterizeTerrain();
+
+		if (fog == null) System.Array.Copy(terrain, target, terrain.Length);
+		else {
+			if (this.fogWidth != fogWidth) MapFog(fogWidth, fogDepth, cellSize);
+			for (int i = 0; i < terrain.Length; i++) {
+				int cell = fogCells[i];
+				Color32 c = terrain[i];
+				if ((fog[cell >> 5] & (1u << (cell & 31))) == 0) {
+					c.r = (byte) (c.r >> 2);
+					c.g = (byte) (c.g >> 2);
+					c.b = (byte) (c.b >> 2);
+				}
+				target[i] = c;
+			}
+		}
+
+		for (int i = 0; i < count; i++) Blit(target, dots[i]);
+	}
+
+	private void RasterizeTerrain(){
+		float[] heights = new float[width * height];
+		float min = float.MaxValue, max = float.MinValue;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				Vector2 world = PixelToWorld(x + 0.5f, y + 0.5f);
+				float h = sampler(world.x, world.y);
+				heights[y * width + x] = h;
+				if (h < min) min = h;
+				if (h > max) max = h;
+			}
+		}
+
+		terrain = new Color32[width * height];
+		float range = max > min ? max - min : 1;
+		for (int i = 0; i < heights.Length; i++) {
+			terrain[i] = Color32.Lerp(LOW, HIGH, (heights[i] - min) / range);
+		}
+	}
+
+	/**
+	* Fog cell of every pixel, calculated once per fog grid
+	*/
+	private void MapFog(int fogWidth, int fogDepth, float cellSize){
+		this.fogWidth = fogWidth;
+		fogCells = new int[width * height];
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				Vector2 world = PixelToWorld(x + 0.5f, y + 0.5f);
+				int cx = Mathf.Clamp((int) ((world.x - area.xMin) / cellSize), 0, fogWidth - 1);
+				int cz = Mathf.Clamp((int) ((world.y - area.yMin) / cellSize), 0, fogDepth - 1);
+				fogCells[y * width + x] = cz * fogWidth + cx;
+			}
+		}
+	}
+
+	private void Blit(Color32[] target, Dot dot){
+		int x0 = PixelX(dot.x) - dot.size / 2;
+		int y0 = PixelY(dot.z) - dot.size / 2;
+		int x1 = Mathf.Min(width, x0 + dot.size);
+		int y1 = Mathf.Min(height, y0 + dot.size);
+		for (int y = Mathf.Max(0, y0); y < y1; y++) {
+			int row = y * width;
+			for (int x = Mathf.Max(0, x0); x < x1; x++) target[row + x] = dot.color;
+		}
+	}
+}
@@ -51,8 +51,7 @@ public class Train : MonoBehaviour {
 				Debug.Log("Researching" + strategyObject.name);
 				
 				//strategyObject.name = unitName + counter++;
-				building.train (strategyObject);
-				building.cancelButtons.Add (CancelTrainUnit.AddCancelButton(strategyObject, building, queueSize));
+				CommandStream.Issue(Command.Train(building, strategyObject));
 			}
 		}
 		
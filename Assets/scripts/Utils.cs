@@ -48,11 +48,8 @@ public class Utils {
 	}
 
 	public static Vector3 terrainHeight(Vector3 pos) {
-		Terrain terrain = GameObject.Find("Terrain").GetComponent<Terrain>();
-		//float h = terrain.terrainData.GetHeight ((int)pos.x, (int)pos.z);
-		float h = terrain.SampleHeight(pos);
-		//Debug.Log ("Terrain h in pos " + pos + ": " + h);
-		return new Vector3 (pos.x, h, pos.z);
+		//Cached snapshot of the terrain, see Heightfield
+		return Heightfield.Get().OnSurface(pos);
 	}
 
 	
@@ -170,7 +167,7 @@ public class Utils {
 	}
 	
 	public static void PlayAudioOnCamera(AudioClip clip){
-		AudioSource.PlayClipAtPoint(clip, Camera.main.transform.position );
+		AudioEvents.Play2D(clip, AudioEvents.PRIORITY_UI);
 	}
 
 	public static void SetGarbageCollector(GameObject go) {
@@ -0,0 +1,222 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Fog of war: cells seen by each player, from the sight of their units and buildings.
+*
+* Every cell keeps a count of the units of the player that see it, and a bit per player
+* in a packed bit grid (cell seen when count > 0). A tick only reads the units that changed since
+* the last one (see Entities.Changed), and a unit only updates the grid when it changes
+* cell or its sight changes: the circle stencil of its sight is removed from the old cell
+* and added to the new one. Stencils are precomputed per sight radius.
+* It doesn't need a scene when created with a Rect, see VisibilityCheck (editor, batch mode).
+*/
+public class Visibility {
+
+	public const float CELL_SIZE = 1; //In world units
+
+	private static Visibility active;
+
+	public readonly int width;
+	public readonly int depth;
+	private readonly Vector2 origin;
+
+	private List<ushort[]> counts = new List<ushort[]>(); //[player id][cell], see Teams
+	private List<uint[]> bits = new List<uint[]>(); //[player id][cell / 32]
+	private Dictionary<int, int[]> stencils = new Dictionary<int, int[]>(); //Radius -> (dx, dz) pairs
+
+	private Dictionary<int, Viewer> viewers = new Dictionary<int, Viewer>();
+
+	public int updatedLastTick; //Units that changed cell in the last tick
+
+	private class Viewer {
+		public int player;
+		public int x = -1;
+		public int z;
+		public int radius;
+	}
+
+	public Visibility(Rect area){
+		origin = new Vector2(area.xMin, area.yMin);
+		width = Mathf.CeilToInt(area.width / CELL_SIZE);
+		depth = Mathf.CeilToInt(area.height / CELL_SIZE);
+	}
+
+	/**
+	* Visibility of the terrain of the scene
+	*/
+	public static Visibility Get(){
+		if (active == null) {
+			active = new Visibility(Heightfield.Get().Bounds);
+			//Created after the first units, later ones come from Entities.Changed
+			foreach (MonoBehaviour entity in Entities.All) {
+				Playable p = entity as Playable;
+				if (p != null) active.Update(p);
+			}
+		}
+		return active;
+	}
+
+	public static void Reset(){
+		active = null;
+	}
+
+	// ------------------------------------
+	// UPDATE
+	// ------------------------------------
+
+	/**
+	* Update the cells of the entities that changed since the last tick, call once per frame before Entities.ClearChanges
+	*/
+	public void Tick(){
+		updatedLastTick = 0;
+
+		List<int> removed = Entities.Removed;
+		for (int i = 0; i < removed.Count; i++) {
+			Viewer v;
+			if (!viewers.TryGetValue(removed[i], out v)) continue;
+			Remove(v);
+			viewers.Remove(removed[i]);
+		}
+
+		List<Playable> changed = Entities.Changed;
+		for (int i = 0; i < changed.Count; i++) {
+			Playable p = changed[i];
+			//Destroyed, or unregistered with its id given to another entity (see Snapshot)
+			if (p == null || p.id == 0 || Entities.Get<Playable>(p.id) != p) continue;
+			Update(p);
+		}
+	}
+
+	private void Update(Playable p){
+		int player = Player(p.owner);
+		Viewer v;
+		if (!viewers.TryGetValue(p.id, out v)) {
+			if (player < 0) return;
+			v = new Viewer();
+			v.player = player;
+			viewers.Add(p.id, v);
+		} else if (v.player != player) {
+			//Id given to an entity of another player (see Entities.Register)
+			Remove(v);
+			if (player < 0) {
+				viewers.Remove(p.id);
+				return;
+			}
+			v.player = player;
+		}
+
+		Vector3 pos = p.transform.position;
+		Move(v, CellX(pos.x), CellZ(pos.z), Mathf.CeilToInt(p.sight / CELL_SIZE));
+	}
+
+	/**
+	* Move a viewer to a new cell, only the stencils of the old and new cells are touched
+	*/
+	private void Move(Viewer v, int x, int z, int radius){
+		if (v.x == x && v.z == z && v.radius == radius) return;
+
+		Remove(v);
+		v.x = x;
+		v.z = z;
+		v.radius = radius;
+		Stamp(v, 1);
+		updatedLastTick++;
+	}
+
+	private void Remove(Viewer v){
+		if (v.x >= 0) Stamp(v, -1);
+		v.x = -1;
+	}
+
+	private void Stamp(Viewer v, int delta){
+		ushort[] count = counts[v.player];
+		uint[] bit = bits[v.player];
+		int[] stencil = Stencil(v.radius);
+
+		for (int i = 0; i < stencil.Length; i += 2) {
+			int x = v.x + stencil[i];
+			int z = v.z + stencil[i+1];
+			if (x < 0 || x >= width || z < 0 || z >= depth) continue;
+
+			int cell = z * width + x;
+			int c = count[cell] + delta;
+			count[cell] = (ushort) c;
+			if (c == 0) bit[cell >> 5] &= ~(1u << (cell & 31));
+			else if (c == 1 && delta > 0) bit[cell >> 5] |= 1u << (cell & 31);
+		}
+	}
+
+	/**
+	* Cell offsets inside a circle of the radius, computed once per radius
+	*/
+	private int[] Stencil(int radius){
+		int[] stencil;
+		if (!stencils.TryGetValue(radius, out stencil)) {
+			List<int> offsets = new List<int>();
+			for (int dz = -radius; dz <= radius; dz++) {
+				for (int dx = -radius; dx <= radius; dx++) {
+					if (dx * dx + dz * dz <= radius * radius) {
+						offsets.Add(dx);
+						offsets.Add(dz);
+					}
+				}
+			}
+			stencil = offsets.ToArray();
+			stencils.Add(radius, stencil);
+		}
+		return stencil;
+	}
+
+	private int Player(int owner){
+		if (owner < 0) return -1;
+
+		while (counts.Count <= owner) {
+			counts.Add(new ushort[width * depth]);
+			bits.Add(new uint[(width * depth + 31) / 32]);
+		}
+		return owner;
+	}
+
+	private int CellX(float x){
+		return Mathf.Clamp((int) ((x - origin.x) / CELL_SIZE), 0, width - 1);
+	}
+
+	private int CellZ(float z){
+		return Mathf.Clamp((int) ((z - origin.y) / CELL_SIZE), 0, depth - 1);
+	}
+
+	// ------------------------------------
+	// QUERIES
+	// ------------------------------------
+
+	public bool IsVisible(string player, Vector3 position){
+		return IsVisible(Teams.Id(player), position);
+	}
+
+	/**
+	* Visibility for a player id, see Teams
+	*/
+	public bool IsVisible(int player, Vector3 position){
+		if (player < 0 || player >= bits.Count) return false;
+
+		int cell = CellZ(position.z) * width + CellX(position.x);
+		return (bits[player][cell >> 5] & (1u << (cell & 31))) != 0;
+	}
+
+	/**
+	* Packed visibility of a player, bit (z * width + x) set if the cell is seen. Null if the player has no units yet.
+	* Used to render the fog (eg: minimap)
+	*/
+	public uint[] Bits(string player){
+		return Bits(Teams.Id(player));
+	}
+
+	/**
+	* Packed visibility for a player id, see Teams
+	*/
+	public uint[] Bits(int player){
+		if (player < 0 || player >= bits.Count) return null;
+		return bits[player];
+	}
+}
@@ -0,0 +1,128 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.IO;
+
+public enum CommandType : byte {
+	Move,
+	Attack,
+	Collect,
+	Build,
+	Place,
+	Train,
+	Spawn
+}
+
+/**
+* Order given by a player (human or computer).
+* Units and targets are referenced by entity id (see Entities) so the command can be saved and replayed.
+*/
+public class Command {
+
+	public int tick;
+	public CommandType type;
+	public string player;
+	public int[] units;
+	public int target;
+	public Vector3 position;
+	public string template = ""; //Name of the building, unit or research for Place, Train and Spawn
+
+	// ------------------------------------
+	// FACTORIES
+	// ------------------------------------
+
+	public static Command Move(Playable[] units, Vector3 position){
+		Command c = Create(CommandType.Move, units);
+		c.position = position;
+		return c;
+	}
+
+	public static Command Attack(Playable[] units, Playable target){
+		Command c = Create(CommandType.Attack, units);
+		c.target = target.id;
+		return c;
+	}
+
+	public static Command Collect(Playable[] workers, Resource resource){
+		Command c = Create(CommandType.Collect, workers);
+		c.target = resource.id;
+		return c;
+	}
+
+	/**
+	* Continue building an unfinished building
+	*/
+	public static Command Build(Worker worker, Building building){
+		Command c = Create(CommandType.Build, new Playable[]{worker});
+		c.target = building.id;
+		return c;
+	}
+
+	/**
+	* Place a new building and start building it
+	*/
+	public static Command Place(Worker worker, Building template, Vector3 position){
+		Command c = Create(CommandType.Place, new Playable[]{worker});
+		c.template = template.name;
+		c.position = position;
+		return c;
+	}
+
+	public static Command Train(Building building, StrategyObject strategyObject){
+		Command c = Create(CommandType.Train, new Playable[]{building});
+		c.template = strategyObject.name;
+		return c;
+	}
+
+	public static Command Spawn(string player, string unit, Vector3 position){
+		Command c = new Command();
+		c.type = CommandType.Spawn;
+		c.player = player;
+		c.units = new int[0];
+		c.template = unit;
+		c.position = position;
+		return c;
+	}
+
+	private static Command Create(CommandType type, Playable[] units){
+		Command c = new Command();
+		c.type = type;
+		c.units = new int[units.Length];
+		for (int i = 0; i < units.Length; i++) c.units[i] = units[i].id;
+		c.player = units.Length > 0 ? units[0].tag : "";
+		return c;
+	}
+
+	// ------------------------------------
+	// SERIALIZATION
+	// ------------------------------------
+
+	public void Write(BinaryWriter writer){
+		writer.Write(tick);
+		writer.Write((byte) type);
+		writer.Write(player);
+		writer.Write((ushort) units.Length);
+		foreach (int id in units) writer.Write(id);
+		writer.Write(target);
+		writer.Write(position.x);
+		writer.Write(position.y);
+		writer.Write(position.z);
+		writer.Write(template);
+	}
+
+	public static Command Read(BinaryReader reader){
+		Command c = new Command();
+		c.tick = reader.ReadInt32();
+		c.type = (CommandType) reader.ReadByte();
+		c.player = reader.ReadString();
+		c.units = new int[reader.ReadUInt16()];
+		for (int i = 0; i < c.units.Length; i++) c.units[i] = reader.ReadInt32();
+		c.target = reader.ReadInt32();
+		c.position = new Vector3(reader.ReadSingle(), reader.ReadSingle(), reader.ReadSingle());
+		c.template = reader.ReadString();
+		return c;
+	}
+
+	public override string ToString(){
+		return type + "@" + tick + " " + player + " units " + units.Length + " target " + target;
+	}
+}
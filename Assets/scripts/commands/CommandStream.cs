@@ -0,0 +1,242 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.IO;
+using System;
+
+/**
+* All the player orders go through the command stream, so a game can be recorded and replayed.
+*
+* Record: game -record replay.bin
+* Replay: game -replay replay.bin
+*
+* Both modes run at a fixed frame rate (Time.captureFramerate) and start with the same random seed,
+* so the replay is the same game and can be used to compare performance between builds.
+* Paths are calculated on other threads and can arrive on a different frame,
+* use "Thread count: None" in the AstarPath object for exact replays.
+*
+* In a lockstep game (see Lockstep) issued commands are sent to the other peers and executed
+* some ticks later, and the ticks only advance when the commands of all the peers have arrived.
+*/
+public class CommandStream {
+
+	private const int MAGIC = 0x52434353; //SCCR
+	private const int VERSION = 1;
+	public const int FRAME_RATE = 30;
+
+	public static int tick = 0;
+	public static int seed;
+
+	private static List<Command> recorded;
+	private static string recordPath;
+	private static Queue<Command> replay;
+	private static List<Command> scheduled = new List<Command>(); //Lockstep commands of the tick
+
+	public static bool Recording {
+		get { return recorded != null; }
+	}
+	public static bool Replaying {
+		get { return replay != null; }
+	}
+
+	// ------------------------------------
+	// GAME LOOP
+	// ------------------------------------
+
+	/**
+	* Read the command line and initialize the random seed, call before creating anything
+	*/
+	public static void Start(){
+		tick = 0;
+		recorded = null;
+		replay = null;
+		seed = Environment.TickCount;
+
+		string[] args = Environment.GetCommandLineArgs();
+		for (int i = 0; i < args.Length - 1; i++) {
+			if (args[i] == "-record") StartRecording(args[i+1]);
+			else if (args[i] == "-replay") Load(args[i+1]);
+		}
+
+		UnityEngine.Random.seed = seed;
+		Lockstep.Start();
+		//Lockstep peers advance one tick per frame, Time has to advance the same on all of them
+		if (Recording || Replaying || Lockstep.Active) Time.captureFramerate = FRAME_RATE;
+	}
+
+	/**
+	* Execute the replayed or lockstep commands of this tick, call once per frame.
+	* In lockstep the tick doesn't advance until the commands of all the peers have arrived
+	*/
+	public static void Tick(){
+		if (Replaying) {
+			//Replaying is tested again, a command can stop the replay (see Template)
+			while (Replaying && replay.Count > 0 && replay.Peek().tick <= tick) Execute(replay.Dequeue());
+		}
+		if (Lockstep.Active) {
+			if (!Lockstep.Ready(tick)) return;
+			scheduled.Clear();
+			Lockstep.Commands(tick, scheduled);
+			foreach (Command c in scheduled) Run(c);
+		}
+		tick++;
+	}
+
+	/**
+	* Record and execute a command, or send it in a lockstep game. Live commands are ignored while replaying
+	*/
+	public static void Issue(Command c){
+		if (Replaying) return;
+		if (Lockstep.Active) {
+			Lockstep.Issue(c);
+			return;
+		}
+
+		c.tick = tick;
+		Run(c);
+	}
+
+	private static void Run(Command c){
+		if (Recording) recorded.Add(c);
+		Execute(c);
+	}
+
+	// ------------------------------------
+	// RECORDING
+	// ------------------------------------
+
+	public static void StartRecording(string path){
+		Debug.Log ("Recording commands to " + path);
+		recordPath = path;
+		recorded = new List<Command>();
+	}
+
+	/**
+	* Write the recorded commands to disk
+	*/
+	public static void Stop(){
+		Lockstep.Stop();
+		if (!Recording) return;
+
+		using (BinaryWriter writer = new BinaryWriter(File.Open(recordPath, FileMode.Create))) {
+			writer.Write(MAGIC);
+			writer.Write(VERSION);
+			writer.Write(seed);
+			writer.Write(tick);
+			writer.Write(recorded.Count);
+			foreach (Command c in recorded) c.Write(writer);
+		}
+		Debug.Log ("Recorded " + recorded.Count + " commands in " + tick + " ticks to " + recordPath);
+		recorded = null;
+	}
+
+	private static void Load(string path){
+		Debug.Log ("Replaying commands from " + path);
+		using (BinaryReader reader = new BinaryReader(File.OpenRead(path))) {
+			if (reader.ReadInt32() != MAGIC) throw new InvalidDataException("Not a command stream: " + path);
+			int version = reader.ReadInt32();
+			if (version != VERSION) throw new InvalidDataException("Unsupported command stream version " + version);
+
+			seed = reader.ReadInt32();
+			int ticks = reader.ReadInt32();
+			int count = reader.ReadInt32();
+
+			replay = new Queue<Command>(count);
+			for (int i = 0; i < count; i++) replay.Enqueue(Command.Read(reader));
+			Debug.Log ("Loaded " + count + " commands, " + ticks + " ticks");
+		}
+	}
+
+	// ------------------------------------
+	// EXECUTION
+	// ------------------------------------
+
+	private static void Execute(Command c){
+		switch (c.type) {
+		case CommandType.Move:
+			foreach (Playable p in Units<Playable>(c)) p.MoveTo(c.position);
+			break;
+		case CommandType.Attack:
+			Playable target = Entities.Get<Playable>(c.target);
+			if (target != null) foreach (Playable p in Units<Playable>(c)) p.Attack(target);
+			break;
+		case CommandType.Collect:
+			Resource resource = Entities.Get<Resource>(c.target);
+			if (resource != null) foreach (Worker w in Units<Worker>(c)) w.Collect(resource);
+			break;
+		case CommandType.Build:
+			Building unfinished = Entities.Get<Building>(c.target);
+			if (unfinished != null) foreach (Worker w in Units<Worker>(c)) w.Build(unfinished);
+			break;
+		case CommandType.Place:
+			ExecutePlace(c);
+			break;
+		case CommandType.Train:
+			foreach (Building b in Units<Building>(c)) ExecuteTrain(b, c.template);
+			break;
+		case CommandType.Spawn:
+			ExecuteSpawn(c);
+			break;
+		}
+	}
+
+	private static void ExecutePlace(Command c){
+		List<Worker> workers = Units<Worker>(c);
+		if (workers.Count == 0) return;
+
+		Building template = Template<Building>(c);
+		if (template == null) return;
+		Player player = Gameplay.getPlayer(c.player);
+		if (!player.consumeResources(template.cost)) {
+			if (player == Gameplay.player1) Utils.PlayAudioOnCamera(Gameplay.st.notEnoughResource1);
+			return;
+		}
+
+		//Use the ghost building of the interface if it's the same one
+		Building building = Gui.buildingSelected;
+		if (building == null || building.name != template.name + "(Clone)") building = Building.BuildPlace(template);
+		else Gui.buildingSelected = null;
+
+		building.transform.position = c.position;
+		building.BuildStart(workers[0]);
+	}
+
+	private static void ExecuteTrain(Building building, string name){
+		StrategyObject strategyObject = building.Developable(name);
+		if (strategyObject == null) return;
+
+		int queueSize = building.trainingQueue.Count;
+		building.train(strategyObject);
+		building.cancelButtons.Add(CancelTrainUnit.AddCancelButton(strategyObject, building, queueSize));
+	}
+
+	private static void ExecuteSpawn(Command c){
+		Unit template = Template<Unit>(c);
+		if (template == null) return;
+		Unit unit = (Unit) Unit.create(template, c.position, c.player);
+
+		AiRush rush = Gameplay.getPlayer(c.player) as AiRush;
+		if (rush != null) rush.AddEnemy(unit);
+	}
+
+	/**
+	* Template of a command, see Templates. A missing template stops the replay, the game would diverge anyway
+	*/
+	private static T Template<T>(Command c) where T : StrategyObject {
+		T template = Templates.Get<T>(c.template);
+		if (template == null) {
+			Debug.LogError("Command " + c.type + " at tick " + c.tick + ": no " + typeof(T).Name + " template named " + c.template +
+				(Replaying ? ", stopping the replay" : ""));
+			replay = null;
+		}
+		return template;
+	}
+
+	private static List<T> Units<T>(Command c) where T : Playable {
+		List<T> units = new List<T>(c.units.Length);
+		foreach (int id in c.units) {
+			T unit = Entities.Get<T>(id);
+			if (unit != null) units.Add(unit);
+		}
+		return units;
+	}
+}
@@ -0,0 +1,363 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.IO;
+using System;
+using Stopwatch = System.Diagnostics.Stopwatch;
+
+/**
+* Deterministic lockstep over the command stream: commands are not executed when issued but
+* DELAY ticks later, on every peer at the same tick. A tick only runs when the batches of all the
+* peers for that tick have arrived (empty batches included), otherwise the game waits (time scale 0).
+*
+* Every HASH_INTERVAL ticks the state is hashed and the hash sent with the next batch,
+* a different hash from another peer is a desync.
+*
+* Loopback test: game -lockstep 4 [-latency 80] [-jitter 20]
+* runs the local player with 3 simulated peers in the same process over a LoopbackTransport. The simulated
+* peers don't run a simulation: they answer every batch of the local player with an empty batch for the
+* same tick and the same hash, so the game waits for the round trip as with real peers, and the
+* command latency and the waits can be measured for 2 to 8 players.
+*/
+public class Lockstep {
+
+	public const int DELAY = 4; //Ticks between issuing and executing a command
+	public const int HASH_INTERVAL = 30; //Ticks
+
+	private const int NO_HASH = -1;
+
+	private class Batch {
+		public int peer;
+		public int tick;
+		public int hashTick = NO_HASH;
+		public uint hash;
+		public List<Command> commands = new List<Command>();
+		public long[] issued; //Local batches only, issue timestamp of every command
+	}
+
+	private static Transport transport;
+	private static int peers;
+	private static int localPeer;
+	private static List<SimulatedPeer> simulated = new List<SimulatedPeer>();
+
+	private static List<Command> outgoing = new List<Command>(); //Issued, sent with the next batch
+	private static List<long> outgoingIssued = new List<long>();
+	private static int lastSent; //Tick of the last batch sent
+	private static Dictionary<int, Batch[]> batches = new Dictionary<int, Batch[]>(); //Tick -> batch of every peer
+	private static Dictionary<int, uint> hashes = new Dictionary<int, uint>(); //Local hashes, by tick
+	private static int pendingHashTick = NO_HASH; //Hash to send with the next batch
+	private static bool waiting = false;
+
+	//Statistics
+	public static int ticks;
+	public static int waitFrames; //Frames the game waited for the batches of other peers
+	public static int commands;
+	public static double latencySum, latencyMax; //Ms from issue to execution of the local commands
+	public static int hashesChecked;
+	public static int desyncs;
+
+	public static bool Active {
+		get { return transport != null; }
+	}
+
+	// ------------------------------------
+	// SESSION
+	// ------------------------------------
+
+	/**
+	* Read the command line, called by CommandStream.Start
+	*/
+	public static void Start(){
+		Stop();
+
+		int count = 0;
+		float latency = 80, jitter = 20;
+		string[] args = Environment.GetCommandLineArgs();
+		for (int i = 0; i < args.Length - 1; i++) {
+			if (args[i] == "-lockstep") {
+				if (!int.TryParse(args[i+1], out count)) Debug.LogError("Invalid -lockstep peer count " + args[i+1]);
+			} else if (args[i] == "-latency") latency = ParseMs(args[i], args[i+1], latency);
+			else if (args[i] == "-jitter") jitter = ParseMs(args[i], args[i+1], jitter);
+		}
+		if (count >= 2) StartLoopback(Mathf.Min(count, Teams.MAX_PLAYERS), latency, jitter);
+	}
+
+	private static float ParseMs(string arg, string value, float fallback){
+		float ms;
+		if (float.TryParse(value, System.Globalization.NumberStyles.Float, System.Globalization.CultureInfo.InvariantCulture, out ms) && ms >= 0) return ms;
+		Debug.LogError("Invalid " + arg + " " + value + ", using " + fallback + " ms");
+		return fallback;
+	}
+
+	/**
+	* Local player and count - 1 simulated peers, see SimulatedPeer
+	*/
+	public static void StartLoopback(int count, float latency, float jitter){
+		LoopbackTransport.Hub hub = new LoopbackTransport.Hub(latency, jitter, CommandStream.seed);
+		Start(hub.Connect(), 0, count);
+		for (int peer = 1; peer < count; peer++) simulated.Add(new SimulatedPeer(peer, hub.Connect()));
+		Debug.Log ("Lockstep loopback with " + count + " peers, latency " + latency + " +- " + jitter + " ms");
+	}
+
+	/**
+	* Join a session as peer of count peers
+	*/
+	public static void Start(Transport t, int peer, int count){
+		transport = t;
+		localPeer = peer;
+		peers = count;
+		lastSent = DELAY - 1; //Ticks before the delay have no commands
+		ticks = waitFrames = commands = hashesChecked = desyncs = 0;
+		latencySum = latencyMax = 0;
+	}
+
+	public static void Stop(){
+		if (!Active) return;
+		Debug.Log (Summary());
+
+		transport.Close();
+		transport = null;
+		foreach (SimulatedPeer p in simulated) p.Close();
+		simulated.Clear();
+		outgoing.Clear();
+		outgoingIssued.Clear();
+		batches.Clear();
+		hashes.Clear();
+		pendingHashTick = NO_HASH;
+		if (waiting) Time.timeScale = 1;
+		waiting = false;
+	}
+
+	public static string Summary(){
+		return "Lockstep " + peers + " peers: " + ticks + " ticks, " + waitFrames + " frames waiting, " +
+			commands + " commands, latency " + (commands > 0 ? latencySum / commands : 0).ToString("0.0") + " ms avg " +
+			latencyMax.ToString("0.0") + " ms max, " + transport.bytesSent + " bytes sent, " +
+			hashesChecked + " hashes checked, " + desyncs + " desyncs";
+	}
+
+	// ------------------------------------
+	// TICKS
+	// ------------------------------------
+
+	/**
+	* Queue a local command, sent with the next batch
+	*/
+	public static void Issue(Command c){
+		outgoing.Add(c);
+		outgoingIssued.Add(Stopwatch.GetTimestamp());
+	}
+
+	/**
+	* Send the local batch and receive the others, true if tick can run.
+	* The game is paused while it can't
+	*/
+	public static bool Ready(int tick){
+		if (tick % HASH_INTERVAL == 0 && !hashes.ContainsKey(tick)) {
+			hashes[tick] = StateHash();
+			pendingHashTick = tick;
+		}
+		if (lastSent < tick + DELAY) SendBatch(tick + DELAY);
+
+		foreach (SimulatedPeer p in simulated) p.Update();
+		byte[] message;
+		while ((message = transport.Receive()) != null) Received(Read(message));
+
+		bool ready = tick < DELAY || Complete(tick);
+		if (ready == waiting) {
+			waiting = !ready;
+			Time.timeScale = ready ? 1 : 0;
+		}
+		if (!ready) waitFrames++;
+		return ready;
+	}
+
+	/**
+	* Commands of all the peers for tick, in peer order. The tick is done after this
+	*/
+	public static void Commands(int tick, List<Command> result){
+		Batch[] all;
+		if (batches.TryGetValue(tick, out all)) {
+			long now = Stopwatch.GetTimestamp();
+			foreach (Batch b in all) {
+				result.AddRange(b.commands);
+				if (b.issued == null) continue;
+				foreach (long issued in b.issued) {
+					double latency = (now - issued) * 1000.0 / Stopwatch.Frequency;
+					latencySum += latency;
+					latencyMax = Math.Max(latencyMax, latency);
+				}
+			}
+			batches.Remove(tick);
+		}
+		commands += result.Count;
+		hashes.Remove(tick - HASH_INTERVAL * 4); //Late hashes of other peers are still checked
+		ticks++;
+	}
+
+	private static void SendBatch(int tick){
+		Batch b = new Batch();
+		b.peer = localPeer;
+		b.tick = tick;
+		b.commands.AddRange(outgoing);
+		b.issued = outgoingIssued.ToArray();
+		foreach (Command c in b.commands) c.tick = tick;
+		if (pendingHashTick != NO_HASH) {
+			b.hashTick = pendingHashTick;
+			b.hash = hashes[pendingHashTick];
+			pendingHashTick = NO_HASH;
+		}
+		outgoing.Clear();
+		outgoingIssued.Clear();
+
+		lastSent = tick;
+		Store(b);
+		transport.Send(Write(b));
+	}
+
+	private static void Received(Batch b){
+		if (b.peer < 0 || b.peer >= peers || b.peer == localPeer) return;
+		Store(b);
+
+		uint local;
+		if (b.hashTick == NO_HASH || !hashes.TryGetValue(b.hashTick, out local)) return;
+		hashesChecked++;
+		if (local != b.hash) {
+			desyncs++;
+			Debug.LogError("Lockstep desync with peer " + b.peer + " at tick " + b.hashTick);
+		}
+	}
+
+	private static void Store(Batch b){
+		Batch[] all;
+		if (!batches.TryGetValue(b.tick, out all)) {
+			all = new Batch[peers];
+			batches.Add(b.tick, all);
+		}
+		all[b.peer] = b;
+	}
+
+	private static bool Complete(int tick){
+		Batch[] all;
+		if (!batches.TryGetValue(tick, out all)) return false;
+		foreach (Batch b in all) if (b == null) return false;
+		return true;
+	}
+
+	// ------------------------------------
+	// STATE HASH
+	// ------------------------------------
+
+	/**
+	* Hash of the entities and the players, independent of the iteration order.
+	* Positions are rounded to cm so the hash only changes with visible differences
+	*/
+	public static uint StateHash(){
+		uint hash = 0;
+		foreach (MonoBehaviour entity in Entities.All) {
+			if (entity == null) continue;
+			Vector3 pos = entity.transform.position;
+			uint h;
+			Resource r = entity as Resource;
+			if (r != null) h = Combine((uint) r.id, (uint) r.quantity);
+			else {
+				Playable p = (Playable) entity;
+				h = Combine((uint) p.id, (uint) p.life);
+				h = Combine(h, (uint) p.owner);
+			}
+			h = Combine(h, (uint) Mathf.RoundToInt(pos.x * 100));
+			h = Combine(h, (uint) Mathf.RoundToInt(pos.y * 100));
+			h = Combine(h, (uint) Mathf.RoundToInt(pos.z * 100));
+			hash += Mix(h);
+		}
+		for (int i = 0; i < Teams.Count; i++) {
+			Player player = Teams.Get(i);
+			uint h = (uint) i;
+			foreach (int resource in player.resources) h = Combine(h, (uint) resource);
+			h = Combine(h, (uint) player.totalSupply);
+			hash += Mix(h);
+		}
+		return hash;
+	}
+
+	private static uint Combine(uint h, uint value){
+		return (h ^ value) * 16777619; //FNV
+	}
+
+	/**
+	* Murmur3 finalizer, so summed hashes don't cancel out
+	*/
+	private static uint Mix(uint h){
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return h;
+	}
+
+	// ------------------------------------
+	// SERIALIZATION
+	// ------------------------------------
+
+	private static byte[] Write(Batch b){
+		MemoryStream stream = new MemoryStream();
+		using (BinaryWriter writer = new BinaryWriter(stream)) {
+			writer.Write(b.peer);
+			writer.Write(b.tick);
+			writer.Write(b.hashTick);
+			writer.Write(b.hash);
+			writer.Write((ushort) b.commands.Count);
+			foreach (Command c in b.commands) c.Write(writer);
+		}
+		return stream.ToArray();
+	}
+
+	private static Batch Read(byte[] message){
+		Batch b = new Batch();
+		using (BinaryReader reader = new BinaryReader(new MemoryStream(message))) {
+			b.peer = reader.ReadInt32();
+			b.tick = reader.ReadInt32();
+			b.hashTick = reader.ReadInt32();
+			b.hash = reader.ReadUInt32();
+			int count = reader.ReadUInt16();
+			for (int i = 0; i < count; i++) b.commands.Add(Command.Read(reader));
+		}
+		return b;
+	}
+
+	// ------------------------------------
+	// LOOPBACK PEERS
+	// ------------------------------------
+
+	/**
+	* Peer without simulation: answers every batch of peer 0 with its own empty batch for the
+	* same tick, echoing the hash (it would have computed the same one)
+	*/
+	private class SimulatedPeer {
+		private readonly int peer;
+		private readonly Transport transport;
+
+		public SimulatedPeer(int peer, Transport transport){
+			this.peer = peer;
+			this.transport = transport;
+		}
+
+		public void Update(){
+			byte[] message;
+			while ((message = transport.Receive()) != null) {
+				Batch received = Read(message);
+				if (received.peer != 0) continue;
+
+				Batch answer = new Batch();
+				answer.peer = peer;
+				answer.tick = received.tick;
+				answer.hashTick = received.hashTick;
+				answer.hash = received.hash;
+				transport.Send(Write(answer));
+			}
+		}
+
+		public void Close(){
+			transport.Close();
+		}
+	}
+}
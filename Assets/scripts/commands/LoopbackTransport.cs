@@ -0,0 +1,87 @@
+using System.Collections.Generic;
+using System.Diagnostics;
+
+/**
+* Transport between peers of the same process, with a simulated network: every message is delivered
+* after a one way latency plus a uniform jitter, so messages can arrive out of order.
+*
+* The endpoints are connected to a Hub: Hub hub = new Hub(80, 20, seed); Transport a = hub.Connect(); ...
+*/
+public class LoopbackTransport : Transport {
+
+	public class Hub {
+		public readonly float latency; //One way, in ms
+		public readonly float jitter; //+- ms
+
+		private readonly System.Random random; //Not UnityEngine.Random, the game random must not change
+		private readonly Stopwatch clock = Stopwatch.StartNew();
+		private readonly List<LoopbackTransport> endpoints = new List<LoopbackTransport>();
+
+		public Hub(float latency, float jitter, int seed){
+			this.latency = latency;
+			this.jitter = jitter;
+			random = new System.Random(seed);
+		}
+
+		public LoopbackTransport Connect(){
+			LoopbackTransport endpoint = new LoopbackTransport(this);
+			endpoints.Add(endpoint);
+			return endpoint;
+		}
+
+		public double Now {
+			get { return clock.Elapsed.TotalMilliseconds; }
+		}
+
+		internal void Deliver(LoopbackTransport from, byte[] message){
+			foreach (LoopbackTransport to in endpoints) {
+				if (to == from || to.closed) continue;
+				Delivery d = new Delivery();
+				d.time = Now + latency + jitter * (2 * random.NextDouble() - 1);
+				d.message = message;
+				to.inbox.Add(d);
+			}
+		}
+	}
+
+	private struct Delivery {
+		public double time;
+		public byte[] message;
+	}
+
+	private readonly Hub hub;
+	private readonly List<Delivery> inbox = new List<Delivery>();
+	private bool closed = false;
+
+	private LoopbackTransport(Hub hub){
+		this.hub = hub;
+	}
+
+	public override void Send(byte[] message){
+		if (closed) return;
+		sent++;
+		bytesSent += message.Length;
+		hub.Deliver(this, message);
+	}
+
+	/**
+	* The earliest message whose delivery time has passed
+	*/
+	public override byte[] Receive(){
+		double now = hub.Now;
+		int first = -1;
+		for (int i = 0; i < inbox.Count; i++) {
+			if (inbox[i].time <= now && (first < 0 || inbox[i].time < inbox[first].time)) first = i;
+		}
+		if (first < 0) return null;
+
+		byte[] message = inbox[first].message;
+		inbox.RemoveAt(first);
+		return message;
+	}
+
+	public override void Close(){
+		closed = true;
+		inbox.Clear();
+	}
+}
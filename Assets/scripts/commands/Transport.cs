@@ -0,0 +1,18 @@
+/**
+* Link between the peers of a lockstep game, see Lockstep.
+* A message sent by a peer is delivered whole to all the other peers, in any order.
+*/
+public abstract class Transport {
+
+	public int sent = 0; //Messages sent since the start
+	public long bytesSent = 0;
+
+	public abstract void Send(byte[] message);
+
+	/**
+	* Next message received, null if there is none
+	*/
+	public abstract byte[] Receive();
+
+	public virtual void Close(){}
+}
@@ -0,0 +1,46 @@
+using UnityEngine;
+
+/**
+* Animator parameters of a unit. Parameter names are hashed once, and the last value sent of every
+* parameter is kept, so the Animator is only called on transitions instead of every frame.
+*/
+public class AnimatorBridge {
+
+	//Parameters
+	public const int MOVING = 0;
+	public const int ATTACK = 1;
+	public const int WORKING = 2;
+
+	private static readonly int[] HASHES = {
+		Animator.StringToHash("Moving"),
+		Animator.StringToHash("Attack"),
+		Animator.StringToHash("Working")
+	};
+
+	public static int sent = 0; //Calls forwarded to the animators since the start, for profiling
+
+	private readonly Animator animator;
+	private int values = 0; //Bit per parameter, last value sent
+	private int known = 0; //Bit per parameter, set once it has been sent
+
+	public AnimatorBridge(Animator animator){
+		this.animator = animator;
+	}
+
+	public void SetBool(int parameter, bool value){
+		int bit = 1 << parameter;
+		if ((known & bit) != 0 && ((values & bit) != 0) == value) return;
+
+		known |= bit;
+		if (value) values |= bit;
+		else values &= ~bit;
+
+		if (animator == null) return;
+		animator.SetBool(HASHES[parameter], value);
+		sent++;
+	}
+
+	public bool GetBool(int parameter){
+		return (values & (1 << parameter)) != 0;
+	}
+}
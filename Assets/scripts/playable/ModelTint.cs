@@ -0,0 +1,77 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Color of some renderers (team, health or placement colors) through a property block, so all the
+* units keep sharing their materials (Renderer.material clones the material of every renderer).
+* The block is only applied when the color changes.
+* Until a color is set, SetAlpha keeps the base color of every renderer.
+* Checked headless by ModelTintCheck (editor, batch mode).
+*/
+public class ModelTint {
+
+	private static readonly int COLOR = Shader.PropertyToID("_Color");
+
+	public static int applied = 0; //Property blocks applied since the start, for profiling
+
+	private readonly Renderer[] renderers;
+	private readonly MaterialPropertyBlock block = new MaterialPropertyBlock();
+	private Color color;
+	private bool hasColor = false;
+	private float alpha = -1; //Alpha over the base colors, while no color is set
+
+	public ModelTint(Renderer[] renderers){
+		this.renderers = renderers;
+	}
+
+	/**
+	* Renderers of the model object and its direct children
+	*/
+	public static ModelTint Model(Transform model){
+		List<Renderer> list = new List<Renderer>();
+		if (model.GetComponent<Renderer>() != null) list.Add(model.GetComponent<Renderer>());
+		foreach (Transform t in model) if (t.GetComponent<Renderer>() != null) list.Add(t.GetComponent<Renderer>());
+		return new ModelTint(list.ToArray());
+	}
+
+	/**
+	* Current color, the color of the shared material of the first renderer until one is set
+	*/
+	public Color Color {
+		get {
+			if (!hasColor && renderers.Length > 0 && renderers[0].sharedMaterial != null) return renderers[0].sharedMaterial.color;
+			return color;
+		}
+	}
+
+	public void Set(Color c){
+		if (hasColor && c == color) return;
+		color = c;
+		hasColor = true;
+
+		block.Clear();
+		block.SetColor(COLOR, c);
+		foreach (Renderer r in renderers) r.SetPropertyBlock(block);
+		applied++;
+	}
+
+	public void SetAlpha(float a){
+		if (hasColor) {
+			Color c = color;
+			c.a = a;
+			Set(c);
+			return;
+		}
+
+		if (a == alpha) return;
+		alpha = a;
+		foreach (Renderer r in renderers) {
+			Color c = r.sharedMaterial != null ? r.sharedMaterial.color : Color.white;
+			c.a = a;
+			block.Clear();
+			block.SetColor(COLOR, c);
+			r.SetPropertyBlock(block);
+		}
+		applied++;
+	}
+}
@@ -0,0 +1,264 @@
+using UnityEngine;
+using System.Collections.Generic;
+using Pathfinding;
+
+/**
+* Path following for a unit: requests paths to a position or a (moving) target and returns
+* the velocity to follow them.
+*
+*  Idle       -> nothing to do
+*  Requesting -> waiting for the seeker (the previous path is still followed if any)
+*  Following  -> moving along the waypoints
+*  Arrived    -> end of the path reached
+*  Blocked    -> no progress or no path, retried after a delay and given up after MAX_FAILURES
+*
+* A given up target is not chased again for GIVE_UP_TIME (eg: an unreachable enemy the unit keeps attacking),
+* new move orders are followed. Stopping drops the path being calculated, its result is ignored.
+*
+* Chased targets are only repathed when they moved more than TARGET_MOVED, and short moves are
+* spliced: only the segment from the end of the current path to the new target is calculated.
+* Path requests of all the units share a budget per frame, extra requests wait for the next frames.
+*/
+public class PathFollower {
+
+	public enum State {
+		Idle,
+		Requesting,
+		Following,
+		Arrived,
+		Blocked
+	}
+
+	public static int requestsPerFrame = 10;
+
+	private const float WAYPOINT_REACHED = 1; //Squared distance
+	private const float TARGET_MOVED = 2;
+	private const float SPLICE_DISTANCE = 8; //Max target move to splice the path instead of a new one
+	private const float BLOCKED_TIME = 1.5f; //Seconds without getting closer to the waypoint
+	private const float RETRY_TIME = 1;
+	private const int MAX_FAILURES = 3;
+	private const float GIVE_UP_TIME = 5; //Seconds before chasing a given up target again
+
+	private static int budgetFrame = -1;
+	private static int budgetUsed = 0;
+
+	public State state = State.Idle;
+
+	private readonly Playable unit;
+	private readonly Seeker seeker;
+
+	private List<Vector3> waypoints = new List<Vector3>();
+	private int current;
+	private Vector3 destination;
+	private bool wantsPath = false; //Waiting for request budget
+	private bool splicing = false;
+
+	private MonoBehaviour target;
+	private MonoBehaviour givenUp; //Last target given up
+	private float givenUpAt;
+	private Path pending; //Requested path, results of other paths are ignored
+
+	private float closestDistance;
+	private float lastProgress;
+	private float blockedSince;
+	private int failures;
+
+	public PathFollower(Playable unit, Seeker seeker){
+		this.unit = unit;
+		this.seeker = seeker;
+	}
+
+	// ------------------------------------
+	// ORDERS
+	// ------------------------------------
+
+	/**
+	* Go to a position, replacing any previous order
+	*/
+	public void MoveTo(Vector3 position){
+		target = null;
+		givenUp = null;
+		failures = 0;
+		Request(position, false);
+	}
+
+	/**
+	* Chase target until it's in range. Returns true when in range
+	*/
+	public bool Follow(MonoBehaviour target, float range){
+		Vector3 pos = unit.transform.position;
+		Vector3 closestPoint = target.GetComponent<Collider>().ClosestPointOnBounds(pos);
+
+		if (Vector3.Distance(closestPoint, pos) <= range) {
+			Stop();
+			state = State.Arrived;
+			return true;
+		}
+
+		if (target == givenUp) {
+			if (givenUpAt + GIVE_UP_TIME > Time.time) return false;
+			givenUp = null;
+		}
+
+		if (target != this.target) {
+			this.target = target;
+			failures = 0;
+			Request(closestPoint, false);
+		} else if (state == State.Idle || state == State.Arrived) {
+			Request(closestPoint, false);
+		} else if (state != State.Blocked && (closestPoint - destination).magnitude > TARGET_MOVED) {
+			bool splice = state == State.Following && (closestPoint - destination).magnitude < SPLICE_DISTANCE;
+			Request(closestPoint, splice);
+		}
+		return false;
+	}
+
+	/**
+	* Follow an already calculated path (eg: shared trips, see Economy), reversed if needed
+	*/
+	public void FollowPath(List<Vector3> path, bool reversed){
+		target = null;
+		givenUp = null;
+		pending = null;
+		wantsPath = false;
+		failures = 0;
+		waypoints.Clear();
+		waypoints.AddRange(path);
+		if (reversed) waypoints.Reverse();
+		current = 0;
+		destination = waypoints[waypoints.Count - 1];
+
+		state = State.Following;
+		closestDistance = float.MaxValue;
+		lastProgress = Time.time;
+	}
+
+	public void Stop(){
+		waypoints.Clear();
+		target = null;
+		pending = null;
+		wantsPath = false;
+		splicing = false;
+		state = State.Idle;
+	}
+
+	public bool HasPath {
+		get { return current < waypoints.Count; }
+	}
+
+	public Vector3 NextWaypoint {
+		get { return waypoints[current]; }
+	}
+
+	// ------------------------------------
+	// UPDATE
+	// ------------------------------------
+
+	/**
+	* Preferred velocity along the path (zero if not moving), call once per frame
+	*/
+	public Vector3 Update(){
+		if (wantsPath) Request(destination, splicing);
+
+		if (state == State.Blocked && blockedSince + RETRY_TIME < Time.time) {
+			if (failures >= MAX_FAILURES) GiveUp();
+			else Request(destination, false);
+		}
+
+		if (!HasPath) return Vector3.zero;
+
+		Vector3 toWaypoint = waypoints[current] - unit.transform.position;
+		if (toWaypoint.sqrMagnitude < WAYPOINT_REACHED) {
+			current++;
+			closestDistance = float.MaxValue;
+			if (!HasPath) {
+				waypoints.Clear();
+				if (state == State.Following) state = State.Arrived;
+				return Vector3.zero;
+			}
+			toWaypoint = waypoints[current] - unit.transform.position;
+		}
+
+		//Blocked detection (eg: pushed against a collider)
+		float distance = toWaypoint.sqrMagnitude;
+		if (distance < closestDistance - 0.01f) {
+			closestDistance = distance;
+			lastProgress = Time.time;
+		} else if (state == State.Following && lastProgress + BLOCKED_TIME < Time.time) {
+			Blocked();
+			return Vector3.zero;
+		}
+
+		return toWaypoint.normalized * unit.speed;
+	}
+
+	// ------------------------------------
+	// PATH REQUESTS
+	// ------------------------------------
+
+	private void Request(Vector3 position, bool splice){
+		destination = position;
+		splicing = splice && HasPath;
+
+		if (seeker == null || !TakeBudget()) {
+			wantsPath = true;
+			return;
+		}
+		wantsPath = false;
+
+		Vector3 start = splicing ? waypoints[waypoints.Count - 1] : unit.transform.position;
+		pending = seeker.StartPath(start, position, OnPathComplete);
+		if (!HasPath) state = State.Requesting;
+	}
+
+	private static bool TakeBudget(){
+		if (budgetFrame != Time.frameCount) {
+			budgetFrame = Time.frameCount;
+			budgetUsed = 0;
+		}
+		if (budgetUsed >= requestsPerFrame) return false;
+		budgetUsed++;
+		return true;
+	}
+
+	public void OnPathComplete(Path p){
+		if (p != pending) return; //Stopped or replaced
+		pending = null;
+
+		p.Claim(this);
+		if (p.error) {
+			Debug.Log ("Oh noes, the target was not reachable: "+p.errorLog);
+			if (!splicing) Blocked();
+		} else {
+			if (!splicing) {
+				waypoints.Clear();
+				current = 0;
+			}
+			//Skip the first point of a spliced segment, it's the end of the current path
+			for (int i = splicing ? 1 : 0; i < p.vectorPath.Count; i++) waypoints.Add(p.vectorPath[i]);
+
+			state = State.Following;
+			failures = 0;
+			closestDistance = float.MaxValue;
+			lastProgress = Time.time;
+		}
+		splicing = false;
+		p.Release(this);
+	}
+
+	private void GiveUp(){
+		MonoBehaviour lost = target;
+		Stop();
+		if (lost != null) {
+			givenUp = lost;
+			givenUpAt = Time.time;
+		}
+	}
+
+	private void Blocked(){
+		failures++;
+		waypoints.Clear();
+		blockedSince = Time.time;
+		state = State.Blocked;
+	}
+}
@@ -43,14 +43,30 @@ public abstract class Playable : StrategyObject {
 	protected bool selected = false;
 	
 	private int maxLife ;
+	private float radius;
 
 	public Playable target;
 
-	private Path path;
-	private int currentWaypoint;
+	public int id; //See Entities, 0 until the object is part of the game
+
+	[NonSerialized]
+	public int owner = Teams.NONE; //Player id, see Teams
+	[NonSerialized]
+	public int teamSlot = -1; //Index in the units of the owner, see Teams
+	[NonSerialized]
+	public bool changeQueued = false; //See Entities.MarkChanged
+
+	private PathFollower follower;
 	protected Seeker seeker;
 
-	protected Animator anim;
+	protected AnimatorBridge anim; //Only sends changes, see AnimatorBridge
+
+	private Renderer[] modelRenderers;
+	private bool hiddenByFog = false;
+
+	private ModelTint tint; //See ModelTint
+	private ModelTint selectionTint;
+	private int selectionLife = int.MinValue; //Life shown in the selection color
 	
 	Dictionary<Action,float> lastAction = new Dictionary<Action,float>(); 
 	
@@ -64,24 +80,29 @@ public abstract class Playable : StrategyObject {
 		Color c = Player.getColor(tag);
 		colorModel (c);
 
-		maxLife = life;
+		if (maxLife == 0) maxLife = life; //Set on creation, life can be restored before Start (see Snapshot)
+		Vector3 size = GetComponent<BoxCollider>().bounds.size;
+		radius = Mathf.Max(size.x, size.z) / 2;
 
 		addSelection();
 
 		seeker = (Seeker) GetComponent<Seeker>();
+		if (seeker != null && tag == InfluenceMap.pathPlayer) seeker.tagPenalties = InfluenceMap.THREAT_PENALTIES;
 
 		//Get animator from model
 		Transform model = transform.Find ("model");
-		anim = model.GetComponent<Animator>();		
+		anim = new AnimatorBridge(model.GetComponent<Animator>());		
+		modelRenderers = model.GetComponentsInChildren<Renderer>();
 
 		//Init action map
 		foreach(Action a in (Action[])Enum.GetValues(typeof(Action))){
 			lastAction.Add(a,0);		
 		}
 
-		GetComponent<AudioSource>().PlayOneShot(audioTrained);
+		AudioEvents.Play(audioTrained, transform.position, AudioEvents.PRIORITY_VOICE);
 		
 		transform.position = Utils.terrainHeight (transform.position);		
+		Entities.MarkChanged(this);
 	}
 	
 	/*
@@ -109,36 +130,86 @@ public abstract class Playable : StrategyObject {
 
 			//Debug.Log ("object " + name + " size " + size);
 		} else selection = s.gameObject;
+		selectionTint = new ModelTint(new Renderer[]{ selection.GetComponent<Renderer>() });
 	}
 
 	public static Playable create(Playable u, Vector3 deploy,string tag){
+		Playable go = createModel(u, deploy, tag);
+		go.register();
+		return go;
+	}
+
+	/**
+	* Creates the object without adding it to the game entities (eg: building placement)
+	*/
+	protected static Playable createModel(Playable u, Vector3 deploy,string tag){
 		//Vector3 inTerrain = Utils.terrainRaycast (deploy);
 		Playable go = (Playable)Instantiate (u, deploy, Quaternion.identity);
 		go.gameObject.tag = tag;
 		go.gameObject.transform.parent = GameObject.Find(tag).transform;
+		go.id = 0;
+		go.owner = Teams.Id(tag);
+		go.maxLife = go.life;
+		return go;
+	}
+
+	/**
+	* Creates the object with a given entity id (see Snapshot)
+	*/
+	public static Playable createWithId(Playable u, Vector3 deploy, string tag, int id){
+		Playable go = createModel(u, deploy, tag);
+		go.register(id);
 		return go;
 	}
 
+	protected void register(){
+		register(0);
+	}
+
+	protected void register(int forcedId){
+		if (id == 0) id = forcedId != 0 ? Entities.Register(this, forcedId) : Entities.Register(this);
+		Teams.Add(this);
+		//Buildings count when finished
+		if (!(this is Building) && player() != null) player().techTree.Added(this);
+	}
+
+	/**
+	* Player of the owner id without the tag lookup (eg: attacks and damage), by tag for objects without owner (scene objects)
+	*/
+	protected override Player player(){
+		return owner >= 0 ? Teams.Get(owner) : base.player();
+	}
+
+	void OnDestroy(){
+		LeaveTechTree(); //Also when destroyed without dying (eg: cancelled, scene unloaded)
+		Entities.Unregister(id);
+		Teams.Remove(this);
+	}
+
+	/**
+	* Remove from the counts of the owner's tech tree, only the first call counts (death, snapshot removal, destroy)
+	*/
+	public void LeaveTechTree(){
+		if (leftTechTree) return;
+		leftTechTree = true;
+		Player p = player();
+		if (p != null) p.techTree.Removed(this);
+	}
+
+	/**
+	* Colors are set without material instances and only on change, see ModelTint
+	*/
+	private ModelTint Tint(){
+		if (tint == null) tint = ModelTint.Model(transform.Find ("model"));
+		return tint;
+	}
+
 	public void colorModel(Color c){
-		Transform model =  transform.Find ("model");
-		if (model.GetComponent<Renderer>() != null)  model.GetComponent<Renderer>().material.color = c;
-		foreach (Transform t in model) if ( t.GetComponent<Renderer>() != null) t.GetComponent<Renderer>().material.color = c;
+		Tint().Set(c);
 	}	
 
 	public void alphaModel(float a) {
-		Transform model =  transform.Find ("model");
-		if (model.GetComponent<Renderer> () != null) {
-			Color color = model.GetComponent<Renderer> ().material.color ;
-			color.a = a;
-			model.GetComponent<Renderer> ().material.color  = color;
-		}
-		foreach (Transform t in model) {
-				if (t.GetComponent<Renderer> () != null) {
-					Color color = t.GetComponent<Renderer> ().material.color;
-					color.a = a;
-					t.GetComponent<Renderer> ().material.color = color;
-				}
-		}
+		Tint().SetAlpha(a);
 	}
 
 	/**
@@ -158,18 +229,18 @@ public abstract class Playable : StrategyObject {
 	protected virtual void OnMouseOver () {
 
 		if (Input.GetMouseButtonDown(0) &&
-		    tag == Gameplay.player1.PLAYER_TAG) {
+		    owner == Gameplay.player1.id) {
 			unselectAll();
 			select ();
 		}
 
 		if ( Controller.RightClickOrTouch()  &&
-		    tag != Gameplay.player1.PLAYER_TAG) {
-			foreach (Playable u in Selected<Playable>()) u.Attack (this);
+		    Teams.AreEnemies(Gameplay.player1.id, owner)) {
+			CommandStream.Issue(Command.Attack(Selected<Playable>(), this));
 		}
 	}
 	private void randomAudio(AudioClip[] audios){
-		if (audios.Length > 0 ) GetComponent<AudioSource>().PlayOneShot(Utils.random (audios));
+		if (audios.Length > 0 ) AudioEvents.Play2D(Utils.random (audios), AudioEvents.PRIORITY_VOICE);
 		else Debug.LogWarning("Missing audios " + name);		
 	}
 	// ------------------------------------
@@ -177,14 +248,34 @@ public abstract class Playable : StrategyObject {
 	// ------------------------------------
 	
 	protected virtual void Update () {
-		if (life <= 0) Die ();
-		
+		//Deaths are resolved by the combat phase, see Combat
+		bool measure = Benchmark.Running;
+		long start = measure ? Benchmark.Now() : 0;
 		attacking();
+		if (measure) {
+			Benchmark.Add(Benchmark.COMBAT, start);
+			start = Benchmark.Now();
+		}
 		if (!immobile) moving();
+		if (measure) Benchmark.Add(Benchmark.MOVEMENT, start);
 
-		if (selected) UpdateSelectLife ();
+		if (selected && life != selectionLife) UpdateSelectLife ();
+		if (owner != Gameplay.player1.id) UpdateFog();
 
+		if (measure) start = Benchmark.Now();
 		Ai();
+		if (measure) Benchmark.Add(Benchmark.AI, start);
+	}
+
+	/**
+	* Hide enemies outside the sight of the player units, only on change
+	*/
+	private void UpdateFog(){
+		bool hidden = !Visibility.Get().IsVisible(Gameplay.player1.id, transform.position);
+		if (hidden == hiddenByFog) return;
+
+		hiddenByFog = hidden;
+		foreach (Renderer r in modelRenderers) r.enabled = !hidden;
 	}
 
 	private void UpdateSelectLife(){
@@ -193,45 +284,45 @@ public abstract class Playable : StrategyObject {
 		float percent = ((float) life) / maxLife;
 
 		Color c = new Color(1 -percent,  percent, 0);
-		selection.GetComponent<Renderer> ().material.color = c;
+		selectionTint.Set(c);
+		selectionLife = life;
 	}
-	protected void Die() {
+	private bool dead = false;
+	private bool leftTechTree = false;
+
+	public virtual void Die() {
+		if (dead) return;
+		dead = true;
+
 		Gameplay.getPlayer(tag).addSupply(this.cost);
+		LeaveTechTree();
 		
-		if (audioDie != null) AudioSource.PlayClipAtPoint(audioDie, transform.position);
+		AudioEvents.Play(audioDie, transform.position, AudioEvents.PRIORITY_DEATH);
 		Destroy (this.gameObject);
 	}
 	private void attacking(){
 		if (target != null){
 			if (target.type == UnitType.Air) attacking (air);
 			else attacking (ground); //GROUND
-		} else if (anim != null) anim.SetBool ("Attack", false);
+		} else if (anim != null) anim.SetBool(AnimatorBridge.ATTACK, false);
 	}
 	private void attacking(Attack attack){
 		if (goTo(target, attack.range) &&
 		    attack.damage != 0 && 
 			doFreq (Action.Attack, attack.speed) ) {
 				performAttack(target, attack);
-		} else anim.SetBool ("Attack", false);
+		} else anim.SetBool(AnimatorBridge.ATTACK, false);
 	}
 	private void moving(){
-		if (path != null) {
-			
-			anim.SetBool("Moving", true);
-			
-			Vector3 dir = (path.vectorPath[currentWaypoint]-transform.position).normalized;
-			dir *= speed* Time.deltaTime;
-			
-			if (currentWaypoint!= 0) faceDirection(path.vectorPath[currentWaypoint]);		
-			
-			Vector3 move = transform.position + dir;
-			transform.position = move;
-			
-			if ( (transform.position-path.vectorPath[currentWaypoint]).sqrMagnitude < 1) {
-				currentWaypoint++;
-			}
-			if (currentWaypoint >= path.vectorPath.Count) path = null; //end of path reached
-		} else anim.SetBool("Moving", false);	
+		Vector3 velocity = Follower().Update();
+		if (velocity != Vector3.zero) {
+			anim.SetBool(AnimatorBridge.MOVING, true);
+			faceDirection(Follower().NextWaypoint);		
+		} else anim.SetBool(AnimatorBridge.MOVING, false);	
+
+		//Moved at the end of the frame avoiding the other units, see Crowd
+		//Idle units are registered too, so they make room for the others
+		Crowd.Move(this, velocity);
 	}
 	/**
 	* Return true every freq seconds 
@@ -283,12 +374,7 @@ public abstract class Playable : StrategyObject {
 	}
 
 	public static void moveSelected(Vector3 position){
-		
-		foreach (Playable comp in Playable.Selected<Playable>()){
-			comp.CancelActions();
-			comp.goTo(position);
-			comp.doAction();		
-		}
+		CommandStream.Issue(Command.Move(Playable.Selected<Playable>(), position));
 	}
 	//Non static
 	public T Closest<T>(string player) where T: Playable{
@@ -327,22 +413,27 @@ public abstract class Playable : StrategyObject {
 	public void doAction(){
 		randomAudio(audioActions);
 	}
+	/**
+	* Cancel everything and move to position (move order)
+	*/
+	public void MoveTo(Vector3 position){
+		CancelActions();
+		goTo(position);
+		doAction();
+	}
 	public virtual void CancelActions(){
 		target = null;
-		path = null;
+		Follower().Stop();
 	}
 	
 	private void performAttack(Playable target, Attack attack){
-		anim.SetBool("Attack", true);
-		GetComponent<AudioSource>().PlayOneShot(attack.audio);
-		//TODO create attack effect: hit, slash or projectile
-		//audioHit.Play ();
+		anim.SetBool(AnimatorBridge.ATTACK, true);
 		int damage = attack.damage;
 		if (player().research.Researched(Research.Available.weapon_level1)) damage += 1;
 
-		target.damage(damage);
-
-		Effects.Sparks(target.transform.position);
+		//Damage, audio and sparks are applied at the end of the frame, when the projectile hits for ranged attacks
+		if (Projectiles.IsRanged(attack)) Projectiles.Launch(this, target, damage, attack);
+		else Combat.Attack(this, target, damage, attack.audio);
 	}
 	/**
 	* Select object as target
@@ -353,6 +444,13 @@ public abstract class Playable : StrategyObject {
 		this.target = target;
 	}
 
+	/**
+	* Radius of the unit on the ground, used to avoid other units
+	*/
+	public float Radius(){
+		return radius;
+	}
+
 	public float distance(MonoBehaviour p){
 		Vector3 pos = this.transform.position;
 		Vector3 closestPoint = p.GetComponent<Collider>().ClosestPointOnBounds(pos);
@@ -365,14 +463,15 @@ public abstract class Playable : StrategyObject {
 	/*
 	* Receives damage
 	*/
-	protected void damage(int dmg){
+	public int TakeDamage(int dmg){
 		
 		if (player().research.Researched(Research.Available.armor_level1)) dmg -= 1;
 		
 		life -= dmg;
-		showDmg(dmg);
+		Entities.MarkChanged(this);
+		return dmg;
 	}
-	private void showDmg(int dmg){
+	public void ShowDamage(int dmg){
 		if (Prefs.showDamage ){
 			GameObject health_dmg = GameObject.Find("Health_dmg");
 			
@@ -390,16 +489,28 @@ public abstract class Playable : StrategyObject {
 	// MOVEMENT AND STARPATH
 	// ------------------------------------
 	
+	/**
+	* Path requests and following, see PathFollower
+	*/
+	private PathFollower Follower(){
+		//Created on demand, orders can be given before Start (eg: just created units)
+		if (follower == null) follower = new PathFollower(this, GetComponent<Seeker>());
+		return follower;
+	}
+
+	public PathFollower.State MovementState(){
+		return Follower().state;
+	}
+
 	public void goTo(MonoBehaviour m){
-		Vector3 pos = this.transform.position;
-		Vector3 closestPoint = m.GetComponent<Collider>().ClosestPointOnBounds(pos);
-		goTo (closestPoint);
+		if (!immobile) Follower().Follow(m, 0);
 	}
 	public void goTo(Vector3 destination){
 		//Debug.Log ("Go from " + transform.position + " to "  +destination);
-		if (!immobile && seeker != null && seeker.IsDone()) {
-			seeker.StartPath (transform.position, destination, OnPathComplete);
-		}
+		if (!immobile) Follower().MoveTo(destination);
+	}
+	public void FollowPath(List<Vector3> path, bool reversed){
+		if (!immobile) Follower().FollowPath(path, reversed);
 	}
 	public bool GoCloser(MonoBehaviour m){
 		return goTo (m, 1f);
@@ -410,28 +521,9 @@ public abstract class Playable : StrategyObject {
 	*/
 	public bool goTo(MonoBehaviour mono, float range){
 		//faceDirection (mono.transform.position);
-		//if ((transform.position - mono.transform.position).magnitude > range) { // resource is too far
-		if (distance (mono) > range){
-			if (path == null) goTo(mono); 
-			return false;
-		}  else  {
-			path = null; //close enough
-			return true;
-		}
-	}
-	public void OnPathComplete (Path p) {
-				p.Claim (this);
-		if (!p.error) {
-			if (path != null) path.Release (this);
-			path = p;
-			//Debug.Log ("path complete " + p);
-			//Reset the waypoint counter
-			currentWaypoint = 0;
-		} else {
-			p.Release (this);
-			Debug.Log ("Oh noes, the target was not reachable: "+p.errorLog);
-		}
-		//seeker.StartPath (transform.position,targetPosition, OnPathComplete);
+		if (immobile) return distance (mono) <= range;
+		//Repaths only if the target moved, see PathFollower
+		return Follower().Follow(mono, range);
 	}
 	public virtual void faceDirection(Vector3 destiny){}
 	// ------------------------------------
@@ -439,14 +531,22 @@ public abstract class Playable : StrategyObject {
 	// ------------------------------------
 	
 	//Ai behaviour for all the units (not computer Ai)
-	//Heavy method
+	//Only the units of the enemy players are checked, see Teams
 	virtual protected void Ai(){
-		string enemyT = Gameplay.enemies(tag);
-		Unit[] enemyUnits = allUnits<Unit>(enemyT);
-	    foreach (Unit enemy in enemyUnits){
-	      float distance = (enemy.transform.position - transform.position).magnitude;
-	      if (distance < sight) target = enemy;
-	      //else path = null; //if we went too far, we need to go back to the original position
-	    }
+		int enemies = Teams.EnemyMask(owner);
+		Visibility visibility = Visibility.Get();
+		Vector3 position = transform.position;
+		float sightSqr = sight * sight;
+		for (int player = 0; enemies != 0; player++, enemies >>= 1) {
+			if ((enemies & 1) == 0) continue;
+			List<Playable> units = Teams.Units(player);
+			for (int i = 0; i < units.Count; i++) {
+				Unit enemy = units[i] as Unit;
+				if (enemy == null) continue;
+				Vector3 enemyPosition = enemy.transform.position;
+				if ((enemyPosition - position).sqrMagnitude >= sightSqr) continue;
+				if (visibility.IsVisible(owner, enemyPosition)) target = enemy;
+			}
+		}
 	}
 }
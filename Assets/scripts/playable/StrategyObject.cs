@@ -11,39 +11,41 @@ public abstract class StrategyObject: MonoBehaviour {
 	public int[] cost = {1,0,0};
 	public float trainingTime = 5;
 	public Playable[] dependencies;
+
+	private int typeId = -1;
+	private int satisfiedVersion = -1;
+	private bool satisfied;
 	
 	public virtual void StartDevelopment(){}
 	public virtual void FinishDevelopment(){}
 	public virtual void CancelDevelopment(){}
 	
 	public virtual bool CanBeDeveloped(){
-		return dependenciesSatisfied(Gameplay.player1.PLAYER_TAG);
+		return dependenciesSatisfied(Gameplay.player1.techTree);
 	}
 
-	private bool dependenciesSatisfied(string tag){
-		GameObject[] gos = GameObject.FindGameObjectsWithTag(tag);
-		List<Playable> satisfied = new List<Playable>();
-		
-		foreach (Playable dep in dependencies) {
-			foreach (GameObject go in gos){
-				if (go.name == dep.gameObject.name+"(Clone)") {
-					Building b = go.GetComponent<Building>();
-					if (b!= null) {
-						Debug.Log ("is moving " + b.isBuilding + " " + b.moving);
-						if (!b.isBuilding && !b.moving) satisfied.Add(dep);
-						else Debug.Log ("Dependency building go.name satisfied "+go.name);
-					} else {
-						satisfied.Add(dep);
-					}
+	/**
+	* Cached until the tech tree changes
+	*/
+	private bool dependenciesSatisfied(TechTree tree){
+		if (satisfiedVersion != tree.version) {
+			satisfied = tree.Satisfied(this);
+			satisfiedVersion = tree.version;
+		}
+		return satisfied;
+	}
 
-					break;
-				} 
-			}
+	/**
+	* Same for a template and its instances, see TechTree
+	*/
+	public int TypeId {
+		get {
+			if (typeId < 0) typeId = TechTree.TypeId(name);
+			return typeId;
 		}
-		return satisfied.Count == dependencies.Length;
 	}
 
-	protected Player player(){
+	protected virtual Player player(){
 		return Gameplay.getPlayer(this.tag);
 	}
 	
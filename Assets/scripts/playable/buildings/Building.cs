@@ -80,7 +80,7 @@ public class Building : Playable {
 		    tag != Gameplay.player1.PLAYER_TAG &&
 		    isBuilding) {
 			Worker w = Selected<Worker>()[0];
-			w.Build(this);
+			CommandStream.Issue(Command.Build(w, this));
 		}
 	}
 	// ------------------------------------
@@ -114,12 +114,21 @@ public class Building : Playable {
 		tag = Gameplay.player1.PLAYER_TAG;
 		isBuilding = false;
 		LayerModel(0); //default layer
-		UpdatePath();
-		InitBuilding();
+		Finished();
 
 		//Job finished
 		Debug.Log ("Building finish " + name);
 	}
+
+	/**
+	* The building is part of the game (path, effects, dependencies and resource drops)
+	*/
+	private void Finished(){
+		UpdatePath();
+		InitBuilding();
+		player().techTree.Added(this);
+		if (Economy.IsDepot(this)) Economy.DepotsChanged(tag);
+	}
 	/**
 	* Inmediately creates a building, do not use in game
 	*/
@@ -127,15 +136,35 @@ public class Building : Playable {
 
 		Building go = (Building) Unit.create( building, deploy, tag);
 
-		go.InitBuilding();
-		go.UpdatePath();
+		go.Finished();
 		return go;
 	}
 
+	/**
+	* Creates a finished or unfinished building with its entity id, see Snapshot
+	*/
+	public static Building Restore(Building building, Vector3 position, string tag, int id, bool finished, float progress){
+		Building go = (Building) Unit.createWithId(building, position, tag, id);
+		go.buildingProgress = progress;
+		go.isBuilding = !finished;
+		if (finished) go.Finished();
+		else {
+			go.LayerModel(8); //wireframe until finished
+			go.UpdatePath();
+		}
+		return go;
+	}
+
+	public float BuildingProgress {
+		get { return buildingProgress; }
+		set { buildingProgress = value; }
+	}
+
 	/**
 	* Start building by a worker
 	*/
-	public void BuildStart(){
+	public void BuildStart(Worker w){
+		register();
 		
 		Debug.Log ("Building " + this.name+ " init");
 		//TODO assign player tag at the begginign (so enemy can attack the building)
@@ -145,7 +174,6 @@ public class Building : Playable {
 		moving  = false;
 		UpdatePath();
 
-		Worker w = Selected<Worker>()[0];
 		w.Build(this);
 		isBuilding = true;
 	}
@@ -159,7 +187,8 @@ public class Building : Playable {
 
 	public static Building BuildPlace(Building building){
 		
-		Building b = (Building) Unit.create( building, Vector3.zero, Gameplay.player1.PLAYER_TAG);
+		//Not an entity until the building starts
+		Building b = (Building) Unit.createModel( building, Vector3.zero, Gameplay.player1.PLAYER_TAG);
 		b.colorModel(Color.green);
 		b.GetComponent<Collider>().isTrigger = true;
 		b.moving  = true;
@@ -257,6 +286,46 @@ public class Building : Playable {
 	// ------------------------------------
 	// TRAINING QUEUE AND ACTIONS
 	// ------------------------------------
+
+	/**
+	* Developable object by name (unit or research), from the building or the scene
+	*/
+	public StrategyObject Developable(string name){
+		foreach (StrategyObject s in developable) if (s.name == name) return s;
+		return Templates.Get<StrategyObject>(name);
+	}
+
+	/**
+	* Seconds since the first element of the queue started
+	*/
+	public float TrainingElapsed {
+		get { return Time.time - trainingStart; }
+	}
+
+	/**
+	* Empty the training queue without refunds (eg: restoring a snapshot)
+	*/
+	public void ClearTraining(){
+		foreach (CancelTrainUnit c in cancelButtons) Destroy(c.gameObject);
+		cancelButtons.Clear();
+		foreach (StrategyObject s in trainingQueue) s.CancelDevelopment();
+		trainingQueue.Clear();
+	}
+
+	/**
+	* Put back a saved queue, resources and supply were already paid (see Snapshot)
+	*/
+	public void RestoreTraining(List<StrategyObject> queue, float elapsed){
+		ClearTraining();
+		for (int i = 0; i < queue.Count; i++) {
+			StrategyObject t = queue[i];
+			trainingQueue.Add(t);
+			t.StartDevelopment();
+			if (i == 0 && t is Research) player().research.StartDevelopment((Research)t);
+			cancelButtons.Add(CancelTrainUnit.AddCancelButton(t, this, i));
+		}
+		trainingStart = Time.time - elapsed;
+	}
 	
 	public void train(StrategyObject t){
 		
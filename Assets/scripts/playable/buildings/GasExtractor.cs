@@ -25,11 +25,19 @@ public class GasExtractor : Building {
 
 
 	public override void InitBuilding(){
+		//Placed without moving (eg: replayed command), look for the geyser below
+		if (collissions.Count == 0) {
+			Bounds bounds = GetComponent<Collider>().bounds;
+			foreach (Collider c in Physics.OverlapSphere(bounds.center, bounds.extents.magnitude)) {
+				if (c.gameObject != gameObject) collissions.Add(c.gameObject);
+			}
+		}
 		foreach(GameObject o in collissions){
 			if (o.name == "geyser") {
 				Resource gas = o.GetComponent<Resource>();
 
-				Utils.CopyComponent( o.GetComponent<Resource>(), this.gameObject);
+				Resource extracted = Utils.CopyComponent( o.GetComponent<Resource>(), this.gameObject);
+				extracted.Register();
 				/*Resource r = gameObject.AddComponent<Resource>();
 				Debug.Log("New gas extractor " + gas.quantity);
 
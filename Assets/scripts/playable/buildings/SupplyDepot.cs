@@ -5,14 +5,17 @@ public class SupplyDepot : Building {
 
 	public int addSupply = 5;	
 
+	private int supplied = 0; //Less than addSupply if the player reached the max supply
+
 	public override void InitBuilding () {
 		base.InitBuilding();
-		Gameplay.getPlayer(tag).maxSupply+=addSupply;
+		supplied = Gameplay.getPlayer(tag).incrSupply(addSupply);
 		Debug.Log ("Incrementing " + tag +" supply " + Gameplay.getPlayer(tag).maxSupply);
 	}
 
-	private void Die() {
-		Gameplay.getPlayer(tag).maxSupply-=addSupply;
+	public override void Die() {
+		Gameplay.getPlayer(tag).incrSupply(-supplied);
+		supplied = 0;
 		base.Die();
 	}
 	
@@ -1,19 +1,16 @@
 ﻿using UnityEngine;
 using System.Collections.Generic;
-using System;
-using System.Collections;
 
 public class Worker : Unit {
 	
-	private int MAX_RESOURCE = 8;
-	private int collectResourceAmount = 0;
-	private int DROP_TIME = 1;
-	public Resource resource;
+	private float DROP_CHECK = 0.5f; //in seconds
+	public Resource resource; //Harvested resource, see Economy
+	public int carried = 0;
+	public int carriedType = 0;
 
 	private Building build;
 
 	private Canvas buildCanvas; 
-	private bool droping = false;
 
 	public void Start(){
 		base.Start();
@@ -30,8 +27,7 @@ public class Worker : Unit {
 		if(selected) buildCanvas.enabled = true;
 		else buildCanvas.enabled = false;
 
-		collect();
-		
+		//Harvest is scheduled by Economy
 		dropResource ();
 
 		building();
@@ -40,43 +36,36 @@ public class Worker : Unit {
 
 	public void Collect(Resource r){
 		CancelActions();
-		goTo (r);
 		resource = r;
+		Economy.Assign(this, r);
 	}
 
-	private void collect(){
-		//TODO Return to base if resource has been consumed completely
-		
-		if (resource != null) {
-			if (collectResourceAmount < MAX_RESOURCE && 
-			    GoCloser(resource) &&
-			    doFreq (Action.Collect, resource.SPEED_COLLECTION)) {
-				//Debug.Log("Collecting resource " + resource.name);
-				if (resource.consume (1))resource=null;
-				collectResourceAmount++;
-				anim.SetBool("Working", true);
-				Effects.Bluesparks(resource.transform.position);
-				
-			} else if(collectResourceAmount >= MAX_RESOURCE){ //GO back to base to drop resources
-				Building building = Utils.closest<Building>("Base", tag, transform.position);
-				if (building != null && GoCloser(building) && !droping) AddResources (); 
-			}
-		} else anim.SetBool("Working", false);
-	}
 	private void dropResource(){
-		//Manually drop resource if you move the unit close to a building
-		if (collectResourceAmount > 0){
+		//Manually drop resource if you move the unit close to a building (not often, and not while harvesting)
+		if (carried > 0 && resource == null && doFreq(Action.Drop, DROP_CHECK)){
 			Building building = Utils.closest<Building>("Base", tag, transform.position);
 			if 	(building != null && 
-			     CloseEnough(building)) StartCoroutine (AddResources ());
-
+			     CloseEnough(building)) Economy.Deposit(this);
 		}
 	}
 	private void building(){
-		if (build != null && GoCloser(build)){
-			anim.SetBool("Working", true);
+		if (build == null) return;
+		if (GoCloser(build)){
+			anim.SetBool(AnimatorBridge.WORKING, true);
 			build = build.Construct(); //Return null when building finish
-		} else anim.SetBool("Working", false);
+			if (build == null) anim.SetBool(AnimatorBridge.WORKING, false);
+		} else anim.SetBool(AnimatorBridge.WORKING, false);
+	}
+
+	public void Working(bool working){
+		if (anim != null) anim.SetBool(AnimatorBridge.WORKING, working);
+	}
+
+	/**
+	* Building being constructed, null if none
+	*/
+	public Building Constructing {
+		get { return build; }
 	}
 
 	public void Build(Building b){
@@ -88,25 +77,11 @@ public class Worker : Unit {
 
 	public override void CancelActions(){
 		base.CancelActions();
+		Economy.Release(this);
 		resource = null;
 		build = null;
 	}
 
-	IEnumerator AddResources(){
-		droping = true;
-		yield return new WaitForSeconds(DROP_TIME);
-		try {
-
-			Gameplay.getPlayer(tag).resources[resource.type]+= collectResourceAmount;
-			collectResourceAmount=0;
-			droping = false;
-		} catch (Exception e){
-			Debug.LogWarning("Got exception "+ e);
-		}
-
-
-	}
-
 	override protected void Ai(){
 		//Do nothing
 	}
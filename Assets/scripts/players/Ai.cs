@@ -5,10 +5,13 @@ using System.Collections;
 
 public class Ai : Player {
 
-	//TODO add dinamically everytime we create a new unit ???
-  private Unit[] allAttackers;
-  private Unit[] allWorkers;
-  private Building[] allBuildings;
+	//Cached world queries, refreshed by the first step of every plan
+	private List<Unit> allAttackers = new List<Unit>();
+	private List<Worker> allWorkers = new List<Worker>();
+	private List<Building> allBuildings = new List<Building>();
+	private List<Resource> allResources = new List<Resource>();
+	private List<Playable> enemyUnits = new List<Playable>();
+	private bool enemiesQueried;
 
 	private bool log = false;
   private List<Building> discoveredBuildings;
@@ -20,36 +23,73 @@ public class Ai : Player {
 	private const int AI_FREQ = 5;
 	private float lastAi = 0;
 
- /* public override void update(){
-		if ( lastAi + AI_FREQ< Time.time) doSomething();
-  }*/
+	private AiPlanner planner;
+	private int nextWorker;
+
+	public void Update(){
+		if (planner == null) createPlanner();
+		if (!planner.Running && lastAi + AI_FREQ < Time.time) doSomething();
+
+		bool measure = Benchmark.Running;
+		long start = measure ? Benchmark.Now() : 0;
+		planner.Update();
+		if (measure) Benchmark.Add(Benchmark.AI, start);
+	}
+
+	/**
+	* Planning is split in steps run within a time budget per frame, see AiPlanner
+	*/
+	private void createPlanner(){
+		planner = new AiPlanner();
+		planner.Add("query", query);
+		planner.Add("collect", collect);
+		planner.Add("attack", delegate () {
+			if (allAttackers.Count >= 5) attack();
+			return true;
+		});
+		planner.Add("train", delegate () {
+			if (allBuildings.Count == 0) return true;
+			if (resources[0] >=15 && allWorkers.Count< 3) createWorker(allBuildings[0]);
+			if (resources[0] >=15 && allAttackers.Count< 5) createAttacker(allBuildings[0]);
+			return true;
+		});
+	}
 
   public void doSomething(){
-	try{
-		allAttackers = Playable.allUnits<Attacker>(PLAYER_TAG);
-		allWorkers = Playable.allUnits<Worker>(PLAYER_TAG);
-		allBuildings = Playable.allUnits<Building>(PLAYER_TAG);
-		if (allAttackers.Length <= 0 || allBuildings.Length <= 0) gameOver();
-
-		if (resources[0] < 15) {
-			collect ();
-		}
-		if (allAttackers.Length >= 5){
-			attack ();
-		}
-		if (resources[0] >=15 && allWorkers.Length< 3){
-			createWorker(allBuildings[0]);
+		if (planner == null) createPlanner();
+		planner.Begin();
+		lastAi= Time.time;
+  }
+
+	/**
+	* Step timings of the last plans
+	*/
+	public AiPlanner Planner {
+		get { return planner; }
+	}
+
+	/**
+	* Classify our units (see Teams) and the resources
+	*/
+	private bool query(){
+		allAttackers.Clear();
+		allWorkers.Clear();
+		allBuildings.Clear();
+		allResources.Clear();
+		foreach (Playable p in Teams.Units(id)) {
+			if (p is Worker) allWorkers.Add((Worker) p);
+			else if (p is Attacker) allAttackers.Add((Attacker) p);
+			else if (p is Building) allBuildings.Add((Building) p);
 		}
-		if (resources[0] >=15 && allAttackers.Length< 5){
-			createAttacker(allBuildings[0]);
+		foreach (MonoBehaviour entity in Entities.All) {
+			if (entity is Resource) allResources.Add((Resource) entity);
 		}
-		
-	} catch (Exception e) {
-			if (log) Debug.LogWarning("Unable to run AI "+e);
-	} 
-	lastAi= Time.time;
+		enemiesQueried = false;
+		nextWorker = 0;
 
-  }
+		if (allAttackers.Count <= 0 || allBuildings.Count <= 0) gameOver();
+		return true;
+	}
 
   private void gameOver(){
 		if (log) Debug.Log ("Enemy doesn't have more units - GAME OVER");
@@ -63,18 +103,50 @@ public class Ai : Player {
   
   void attack(){
 		if (log) Debug.Log ("AI - attack");
-		string enemyT = Gameplay.enemies(PLAYER_TAG);
-		Unit[] enemyUnits = Playable.allUnits<Unit>(enemyT);
-		
-		foreach(Unit u in allAttackers ) u.Attack (enemyUnits[0]);
+		if (!enemiesQueried) {
+			enemyUnits.Clear();
+			Teams.Units(Teams.EnemyMask(id), enemyUnits);
+			enemiesQueried = true;
+		}
+		if (enemyUnits.Count == 0) return;
+
+		//Attack the most valuable and less defended area
+		Playable target = enemyUnits[0];
+		Vector3 position;
+		InfluenceMap influence = InfluenceMap.Get();
+		if (influence != null && influence.BestTarget(PLAYER_TAG, out position)) {
+			foreach (Playable enemy in enemyUnits) {
+				if ((enemy.transform.position - position).sqrMagnitude < (target.transform.position - position).sqrMagnitude) target = enemy;
+			}
+		}
+		foreach(Unit u in allAttackers ) if (u != null) u.Attack (target);
 
   }
   
-  void collect(){
+	/**
+	* Send the workers to the closest resource, continues on the next frame if out of budget
+	*/
+  bool collect(){
+		if (resources[0] >= 15) return true;
 		if (log) Debug.Log ("AI - collect");
-		foreach (Worker u in  allWorkers) {
-			u.resource = Utils.closest<Resource> ("Resource", "Resource", u.transform.position);
+		for (; nextWorker < allWorkers.Count; nextWorker++) {
+			if (planner.OutOfBudget()) return false;
+
+			Worker u = allWorkers[nextWorker];
+			if (u == null) continue;
+			Resource closest = null;
+			float closestDistance = float.MaxValue;
+			foreach (Resource r in allResources) {
+				if (r == null) continue;
+				float distance = (r.transform.position - u.transform.position).sqrMagnitude;
+				if (distance < closestDistance) {
+					closest = r;
+					closestDistance = distance;
+				}
+			}
+			if (u.resource != closest) u.Collect(closest);
 		}
+		return true;
   }
   void createWorker(Building b){
 		if (log) Debug.Log ("AI - create worker");
@@ -0,0 +1,110 @@
+using UnityEngine;
+using System.Collections.Generic;
+using System.Diagnostics;
+
+/**
+* Runs the computer player planning as a list of steps spread over several frames,
+* with a time budget per frame, so the AI never spikes a frame whatever the unit count.
+*
+* A step returns true when it's finished, or false to continue on the next frame
+* (long steps should check OutOfBudget and keep their progress).
+* A step that throws is logged and aborts the plan, the next one starts again from the first step.
+*/
+public class AiPlanner {
+
+	public delegate bool Step();
+
+	public class StepInfo {
+		public string name;
+		public Step step;
+		public float lastMs; //Time spent in the last plan
+		public float maxFrameMs; //Max time spent in a single frame
+		public float totalMs;
+		public int plans;
+		public int errors;
+	}
+
+	public float budgetMs = 1;
+
+	private List<StepInfo> steps = new List<StepInfo>();
+	private int current = -1;
+	private Stopwatch frameWatch = new Stopwatch();
+	private Stopwatch stepWatch = new Stopwatch();
+
+	public void Add(string name, Step step){
+		StepInfo info = new StepInfo();
+		info.name = name;
+		info.step = step;
+		steps.Add(info);
+	}
+
+	public bool Running {
+		get { return current >= 0; }
+	}
+
+	/**
+	* Start a new plan from the first step, ignored if a plan is running
+	*/
+	public void Begin(){
+		if (Running) return;
+		current = 0;
+		foreach (StepInfo s in steps) s.lastMs = 0;
+	}
+
+	public bool OutOfBudget(){
+		return frameWatch.Elapsed.TotalMilliseconds >= budgetMs;
+	}
+
+	/**
+	* Run steps until the budget of this frame is spent, call once per frame
+	*/
+	public void Update(){
+		if (!Running) return;
+
+		frameWatch.Reset();
+		frameWatch.Start();
+		while (current < steps.Count && !OutOfBudget()) {
+			StepInfo s = steps[current];
+
+			stepWatch.Reset();
+			stepWatch.Start();
+			bool finished;
+			try {
+				finished = s.step();
+			} catch (System.Exception e) {
+				stepWatch.Stop();
+				s.errors++;
+				UnityEngine.Debug.LogWarning("AI step " + s.name + " failed, plan aborted: " + e);
+				current = steps.Count;
+				break;
+			}
+			stepWatch.Stop();
+
+			float ms = (float) stepWatch.Elapsed.TotalMilliseconds;
+			s.lastMs += ms;
+			s.totalMs += ms;
+			s.maxFrameMs = Mathf.Max(s.maxFrameMs, ms);
+
+			if (finished) {
+				s.plans++;
+				current++;
+			}
+		}
+		frameWatch.Stop();
+
+		if (current >= steps.Count) current = -1;
+	}
+
+	public List<StepInfo> Steps {
+		get { return steps; }
+	}
+
+	public override string ToString(){
+		string report = "";
+		foreach (StepInfo s in steps) {
+			float avg = s.plans > 0 ? s.totalMs / s.plans : 0;
+			report += s.name + ": last " + s.lastMs.ToString("0.000") + "ms avg " + avg.ToString("0.000") + "ms max frame " + s.maxFrameMs.ToString("0.000") + "ms errors " + s.errors + "\n";
+		}
+		return report;
+	}
+}
@@ -2,6 +2,7 @@
 using System.Collections;
 using UnityEngine.UI;
 using System.Collections.Generic;
+using System.IO;
 
 public class AiRush : Player{
 	private GameObject[] deploys;
@@ -12,19 +13,20 @@ public class AiRush : Player{
 	private int timeToRush = TIME_RUSH;
 	private int enemiesInRush = AMOUNT_RUSH;
 	
-	private Text rushText ; 
-	private string separator = ":";
+	private Hud.Binding rushText ; 
+	private char separator = ':';
 
 	private bool rushInProgress = false;
 	private int level = 0;
 
 	private List<Unit> enemies;
+	private List<Playable> targets = new List<Playable>(); //Enemy units, see Target
 	// Use this for initialization
 	public void Start(){
 		enemies = new List<Unit>();
 		deploys = GameObject.FindGameObjectsWithTag("RushDeploy");
 		
-		rushText  = GameObject.Find("RushText").GetComponent<Text>();
+		rushText  = new Hud.Binding(GameObject.Find("RushText").GetComponent<Text>());
 		printTime();
 
 		InvokeRepeating("PrintRushStatus", 0, 1);
@@ -32,9 +34,33 @@ public class AiRush : Player{
 	}
 
 	private void RefreshAttack(){
+		Playable target = Target();
+		if (target == null) return;
 		foreach(Unit u in enemies)
-			u.Attack(Gameplay.getPlayer("player1").mainBase);	
+			u.Attack(target);	
 	}	
+
+	/**
+	* Enemy building closest to the most valuable and less defended area, main base of the first enemy by default
+	*/
+	private Playable Target(){
+		int enemies = Teams.EnemyMask(id);
+		Playable target = null;
+		for (int player = 0; player < Teams.Count && target == null; player++) {
+			if ((enemies & (1 << player)) != 0) target = Teams.Get(player).mainBase;
+		}
+		Vector3 position;
+		InfluenceMap influence = InfluenceMap.Get();
+		if (influence == null || !influence.BestTarget(PLAYER_TAG, out position)) return target;
+
+		targets.Clear();
+		Teams.Units(enemies, targets);
+		foreach (Playable p in targets) {
+			if (!(p is Building) || p.life <= 0) continue;
+			if (target == null || (p.transform.position - position).sqrMagnitude < (target.transform.position - position).sqrMagnitude) target = p;
+		}
+		return target;
+	}
 	public void Update(){
 		if (timeToRush <= 0) {
 			if( !rushInProgress) {
@@ -57,10 +83,10 @@ public class AiRush : Player{
 		}
 	}
 	private void PrintRushStatus (){
-		if (rushInProgress) rushText.text = "Defeat "+enemies.Count;
+		if (rushInProgress) rushText.Set(Hud.Label("Defeat ", enemies.Count));
 		else {
-			if (separator == ":") separator = " ";
-			else separator = ":";
+			if (separator == ':') separator = ' ';
+			else separator = ':';
 
 			printTime();
 			timeToRush--;
@@ -68,16 +94,8 @@ public class AiRush : Player{
 	}
 
 	private void printTime(){
-		string minutes = "0";
-		if (timeToRush >= 60) minutes = (timeToRush / 60).ToString();
-		string seconds = (timeToRush % 60).ToString();
-		
-		rushText.text =  fillWithZeros(minutes) + separator  + fillWithZeros(seconds);
-	}
-
-	private string fillWithZeros(string str){
-		if (str.Length==1) return "0" + str;
-		else return str;
+		//Cached "mm:ss" strings, see Hud
+		rushText.Set(Hud.Clock(timeToRush, separator));
 	}
 
 	//Coruitine
@@ -109,10 +127,38 @@ public class AiRush : Player{
 		GameObject enemy = GameObject.Find(enemyName);
 
 		//GameObject e = (GameObject) GameObject.Instantiate(enemy, deploy.transform.position, Quaternion.identity);
-		Unit unit = enemy.GetComponent<Unit>();
-		Unit newUnit = (Unit) Unit.create(unit, deploy.transform.position, PLAYER_TAG);
+		CommandStream.Issue(Command.Spawn(PLAYER_TAG, enemyName, deploy.transform.position));
+	}
+
+	public override void Save(BinaryWriter writer){
+		base.Save(writer);
+		writer.Write(timeToRush);
+		writer.Write(enemiesInRush);
+		writer.Write(level);
+		writer.Write(rushInProgress);
+	}
+
+	public override void Load(BinaryReader reader){
+		base.Load(reader);
+		timeToRush = reader.ReadInt32();
+		enemiesInRush = reader.ReadInt32();
+		level = reader.ReadInt32();
+		rushInProgress = reader.ReadBoolean();
+
+		//Rush units keep their saved targets
+		enemies.Clear();
+		foreach (Playable p in Teams.Units(id)) {
+			Unit u = p as Unit;
+			if (u != null) enemies.Add(u);
+		}
+	}
 
+	/**
+	* Called by the command stream when a rush unit is created
+	*/
+	public void AddEnemy(Unit newUnit){
 		enemies.Add(newUnit);
-		newUnit.Attack(Gameplay.getPlayer("player1").mainBase);
+		Playable target = Target();
+		if (target != null) newUnit.Attack(target);
 	}
 }
@@ -0,0 +1,405 @@
+using UnityEngine;
+using System.Collections.Generic;
+using Pathfinding;
+
+/**
+* Coarse grid of influence per player (strength, threat and economic value), aligned with the GridGraph.
+*
+* Every entity is stamped on the cells around it with a precomputed falloff kernel,
+* and is only stamped again when it changes cell or its values change (eg: damage).
+* A tick only reads the units that changed since the last one (see Entities.Changed).
+*
+* Queries read a single cell. BestTarget keeps a max tree of the cell scores per set of enemies,
+* and only the cells touched by a stamp are updated before the next query.
+*/
+public class InfluenceMap {
+
+	public enum Layer {
+		Strength,
+		Threat,
+		Economy
+	}
+	private const int LAYERS = 3;
+
+	public const int CELL_NODES = 4; //Grid graph nodes per cell side
+	private const int STAMP_RADIUS = 1; //In cells, for strength and economy
+	private const float EPSILON = 0.01f; //Layers are sums of stamps and their removals, so they drift around 0
+
+	//Threat against a player is written to the graph as node tags, see ApplyThreatTags
+	private const int THREAT_TAG = 1;
+	private static readonly float[] THREAT_LEVELS = {1, 5, 15};
+	public static readonly int[] THREAT_PENALTIES = new int[32];
+	private const float TAGS_FREQ = 2; //In seconds
+
+	public static string pathPlayer = "player2"; //Player whose paths avoid threat
+
+	private static InfluenceMap active;
+
+	public int width;
+	public int depth;
+	private Matrix4x4 worldToGrid;
+	private Matrix4x4 gridToWorld;
+
+	private float[][] layers; //[player id * LAYERS + layer][z * width + x], see Teams
+	private Dictionary<int, Stamp> stamps = new Dictionary<int, Stamp>();
+	private Dictionary<int, float[]> kernels = new Dictionary<int, float[]>();
+	private List<Targets> targets = new List<Targets>();
+
+	private int[] appliedThreatTags;
+	private float lastTags = 0;
+	private List<int> changedCells = new List<int>(); //Buffers of ApplyThreatTags
+	private List<int> changedTags = new List<int>();
+	private volatile bool tagsPending = false; //Work item of the buffers not run yet
+
+	private class Stamp {
+		public int cell = -1;
+		public int player = -1;
+		public float strength;
+		public float threat;
+		public int threatRadius;
+		public float economy;
+	}
+
+	/**
+	* Scores of the cells for the attackers of a set of enemies, in a max tree so the best one is the root
+	*/
+	private class Targets {
+		public int enemies; //Player mask
+		public int leaves; //Power of two
+		public float[] score; //Economy - threat, NegativeInfinity if there is no enemy
+		public int[] tree; //Best cell of the subtree, -1 if none. Cell i is the leaf leaves + i
+		public bool[] dirty;
+		public List<int> dirtyCells = new List<int>();
+	}
+
+	static InfluenceMap(){
+		for (int i = 0; i < THREAT_LEVELS.Length; i++) THREAT_PENALTIES[THREAT_TAG + i] = 2000 * (i + 1);
+	}
+
+	private InfluenceMap(GridGraph graph){
+		width = Mathf.CeilToInt((float) graph.width / CELL_NODES);
+		depth = Mathf.CeilToInt((float) graph.depth / CELL_NODES);
+		worldToGrid = graph.inverseMatrix;
+		gridToWorld = graph.matrix;
+		layers = new float[0][];
+		appliedThreatTags = new int[width * depth];
+		Debug.Log ("Influence map " + width + "x" + depth);
+	}
+
+	/**
+	* Influence map of the scanned grid graph, null if there is no grid graph
+	*/
+	public static InfluenceMap Get(){
+		if (active == null && AstarPath.active != null && AstarPath.active.astarData.gridGraph != null) {
+			active = new InfluenceMap(AstarPath.active.astarData.gridGraph);
+			//Created after the first units, later ones come from Entities.Changed
+			foreach (MonoBehaviour entity in Entities.All) {
+				Playable p = entity as Playable;
+				if (p != null) active.Restamp(p);
+			}
+		}
+		return active;
+	}
+
+	/**
+	* Called when the level is unloaded
+	*/
+	public static void Reset(){
+		active = null;
+	}
+
+	// ------------------------------------
+	// UPDATE
+	// ------------------------------------
+
+	/**
+	* Stamp the entities that changed since the last tick, call once per frame before Entities.ClearChanges
+	*/
+	public void Tick(){
+		List<int> removed = Entities.Removed;
+		for (int i = 0; i < removed.Count; i++) {
+			Stamp s;
+			if (!stamps.TryGetValue(removed[i], out s)) continue;
+			Apply(s, -1);
+			stamps.Remove(removed[i]);
+		}
+
+		List<Playable> changed = Entities.Changed;
+		for (int i = 0; i < changed.Count; i++) {
+			Playable p = changed[i];
+			//Destroyed, or unregistered with its id given to another entity (see Snapshot)
+			if (p == null || p.id == 0 || Entities.Get<Playable>(p.id) != p) continue;
+			Restamp(p);
+		}
+
+		if (pathPlayer != null && !tagsPending && lastTags + TAGS_FREQ < Time.time) {
+			lastTags = Time.time;
+			ApplyThreatTags(pathPlayer);
+		}
+	}
+
+	private void Restamp(Playable p){
+		Stamp s;
+		if (!stamps.TryGetValue(p.id, out s)) {
+			s = new Stamp();
+			stamps.Add(p.id, s);
+		}
+
+		int player = PlayerIndex(p.owner);
+		int cell = Cell(p.transform.position);
+		float strength = p.life;
+		float threat = Mathf.Max(Dps(p.ground), Dps(p.air));
+		int range = Mathf.Max(p.ground != null ? p.ground.range : 0, p.air != null ? p.air.range : 0);
+		int threatRadius = Mathf.CeilToInt(Mathf.Max(range, p.sight) / (CELL_NODES * NodeSize()));
+		float economy = (p is Worker || p is Building) ? p.cost[0] + p.cost[1] : 0;
+
+		if (player == s.player && cell == s.cell && strength == s.strength && threat == s.threat &&
+		    threatRadius == s.threatRadius && economy == s.economy) return;
+
+		Apply(s, -1);
+		s.player = player;
+		s.cell = cell;
+		s.strength = strength;
+		s.threat = threat;
+		s.threatRadius = threatRadius;
+		s.economy = economy;
+		Apply(s, 1);
+	}
+
+	private static float Dps(Attack a){
+		if (a == null || a.damage == 0 || a.speed <= 0) return 0;
+		return a.damage / a.speed;
+	}
+
+	private void Apply(Stamp s, float sign){
+		if (s.cell < 0 || s.player < 0) return;
+
+		int offset = s.player * LAYERS;
+		StampKernel(s.player, layers[offset + (int) Layer.Strength], s.cell, STAMP_RADIUS, sign * s.strength);
+		StampKernel(s.player, layers[offset + (int) Layer.Economy], s.cell, STAMP_RADIUS, sign * s.economy);
+		StampKernel(s.player, layers[offset + (int) Layer.Threat], s.cell, s.threatRadius, sign * s.threat);
+	}
+
+	/**
+	* Add value to the cells around cell, weighted by the kernel of the radius
+	*/
+	private void StampKernel(int player, float[] layer, int cell, int radius, float value){
+		if (value == 0) return;
+
+		int bit = 1 << player; //Targets of the attackers of the player are updated
+
+		float[] kernel = Kernel(radius);
+		int size = 2 * radius + 1;
+		int cx = cell % width;
+		int cz = cell / width;
+		for (int dz = -radius; dz <= radius; dz++) {
+			int z = cz + dz;
+			if (z < 0 || z >= depth) continue;
+			for (int dx = -radius; dx <= radius; dx++) {
+				int x = cx + dx;
+				if (x < 0 || x >= width) continue;
+				layer[z * width + x] += value * kernel[(dz + radius) * size + dx + radius];
+				for (int t = 0; t < targets.Count; t++) {
+					if ((targets[t].enemies & bit) != 0) MarkDirty(targets[t], z * width + x);
+				}
+			}
+		}
+	}
+
+	/**
+	* Linear falloff weights for a radius, computed once per radius
+	*/
+	private float[] Kernel(int radius){
+		float[] kernel;
+		if (!kernels.TryGetValue(radius, out kernel)) {
+			int size = 2 * radius + 1;
+			kernel = new float[size * size];
+			for (int dz = -radius; dz <= radius; dz++) {
+				for (int dx = -radius; dx <= radius; dx++) {
+					float d = Mathf.Sqrt(dx * dx + dz * dz);
+					kernel[(dz + radius) * size + dx + radius] = Mathf.Max(0, 1 - d / (radius + 1));
+				}
+			}
+			kernels.Add(radius, kernel);
+		}
+		return kernel;
+	}
+
+	private int PlayerIndex(int owner){
+		if (owner < 0) return -1;
+
+		if (layers.Length < (owner + 1) * LAYERS) {
+			float[][] grown = new float[(owner + 1) * LAYERS][];
+			layers.CopyTo(grown, 0);
+			for (int i = layers.Length; i < grown.Length; i++) grown[i] = new float[width * depth];
+			layers = grown;
+		}
+		return owner;
+	}
+
+	private static float NodeSize(){
+		return AstarPath.active.astarData.gridGraph.nodeSize;
+	}
+
+	// ------------------------------------
+	// QUERIES
+	// ------------------------------------
+
+	public int Cell(Vector3 position){
+		Vector3 g = worldToGrid.MultiplyPoint3x4(position);
+		int x = Mathf.Clamp((int) (g.x / CELL_NODES), 0, width - 1);
+		int z = Mathf.Clamp((int) (g.z / CELL_NODES), 0, depth - 1);
+		return z * width + x;
+	}
+
+	public Vector3 CellCenter(int cell){
+		float x = (cell % width + 0.5f) * CELL_NODES;
+		float z = (cell / width + 0.5f) * CELL_NODES;
+		return gridToWorld.MultiplyPoint3x4(new Vector3(x, 0, z));
+	}
+
+	public float Value(string player, Layer layer, int cell){
+		return Value(Teams.Id(player), layer, cell);
+	}
+
+	public float Value(int player, Layer layer, int cell){
+		if (player < 0 || (player + 1) * LAYERS > layers.Length) return 0;
+		return layers[player * LAYERS + (int) layer][cell];
+	}
+
+	/**
+	* Sum of the layer of all the players in the mask (see Teams)
+	*/
+	private float Sum(int players, Layer layer, int cell){
+		float sum = 0;
+		for (int player = 0; players != 0; player++, players >>= 1) {
+			if ((players & 1) != 0) sum += Value(player, layer, cell);
+		}
+		return sum;
+	}
+
+	public float Value(string player, Layer layer, Vector3 position){
+		return Value(player, layer, Cell(position));
+	}
+
+	/**
+	* Threat of the enemies of player on the cell
+	*/
+	public float Threat(string player, int cell){
+		return Sum(Teams.EnemyMask(Teams.Id(player)), Layer.Threat, cell);
+	}
+
+	/**
+	* Most valuable and less defended enemy cell for attacker, the first one on ties
+	*/
+	public bool BestTarget(string attacker, out Vector3 position){
+		Targets t = GetTargets(Teams.EnemyMask(Teams.Id(attacker)));
+		for (int i = 0; i < t.dirtyCells.Count; i++) {
+			int cell = t.dirtyCells[i];
+			t.dirty[cell] = false;
+			t.score[cell] = Score(t.enemies, cell);
+			for (int node = (t.leaves + cell) >> 1; node > 0; node >>= 1) {
+				t.tree[node] = Best(t, t.tree[2 * node], t.tree[2 * node + 1]);
+			}
+		}
+		t.dirtyCells.Clear();
+
+		int best = t.tree[1];
+		bool found = best >= 0 && !float.IsNegativeInfinity(t.score[best]);
+		position = found ? CellCenter(best) : Vector3.zero;
+		return found;
+	}
+
+	private float Score(int enemies, int cell){
+		if (Sum(enemies, Layer.Strength, cell) <= EPSILON) return float.NegativeInfinity;
+		return Sum(enemies, Layer.Economy, cell) - Sum(enemies, Layer.Threat, cell);
+	}
+
+	private static int Best(Targets t, int a, int b){
+		if (a < 0) return b;
+		if (b < 0) return a;
+		return t.score[a] >= t.score[b] ? a : b;
+	}
+
+	private void MarkDirty(Targets t, int cell){
+		if (t.dirty[cell]) return;
+		t.dirty[cell] = true;
+		t.dirtyCells.Add(cell);
+	}
+
+	/**
+	* Scores of the enemies mask, built with every cell on the first query
+	*/
+	private Targets GetTargets(int enemies){
+		for (int i = 0; i < targets.Count; i++) if (targets[i].enemies == enemies) return targets[i];
+
+		int cells = width * depth;
+		Targets t = new Targets();
+		t.enemies = enemies;
+		t.leaves = Mathf.NextPowerOfTwo(cells);
+		t.score = new float[cells];
+		t.tree = new int[2 * t.leaves];
+		t.dirty = new bool[cells];
+		for (int i = 0; i < t.leaves; i++) {
+			if (i < cells) t.score[i] = Score(enemies, i);
+			t.tree[t.leaves + i] = i < cells ? i : -1;
+		}
+		for (int node = t.leaves - 1; node > 0; node--) t.tree[node] = Best(t, t.tree[2 * node], t.tree[2 * node + 1]);
+		targets.Add(t);
+		return t;
+	}
+
+	// ------------------------------------
+	// PATHFINDING
+	// ------------------------------------
+
+	/**
+	* Tag the graph nodes with the threat level against player, only the cells whose level changed.
+	* Seekers of the player use THREAT_PENALTIES as tag penalties (see Playable.Start).
+	* Nodes with other tags (set in the scene) keep them.
+	* The buffers are reused, so it does nothing until the work item of the last call has run
+	*/
+	public void ApplyThreatTags(string player){
+		if (tagsPending) return;
+
+		GridGraph graph = AstarPath.active.astarData.gridGraph;
+		List<int> changed = changedCells;
+		List<int> levels = changedTags;
+		changed.Clear();
+		levels.Clear();
+		int enemies = Teams.EnemyMask(Teams.Id(player));
+		for (int cell = 0; cell < width * depth; cell++) {
+			float threat = Sum(enemies, Layer.Threat, cell);
+			int level = 0;
+			while (level < THREAT_LEVELS.Length && threat >= THREAT_LEVELS[level]) level++;
+			int tag = level == 0 ? 0 : THREAT_TAG + level - 1;
+			if (tag != appliedThreatTags[cell]) {
+				appliedThreatTags[cell] = tag;
+				changed.Add(cell);
+				levels.Add(tag);
+			}
+		}
+		if (changed.Count == 0) return;
+
+		tagsPending = true;
+		int cellsWidth = width;
+		AstarPath.active.AddWorkItem(new AstarPath.AstarWorkItem(delegate (bool force) {
+			for (int i = 0; i < changed.Count; i++) {
+				int cx = changed[i] % cellsWidth * CELL_NODES;
+				int cz = changed[i] / cellsWidth * CELL_NODES;
+				for (int z = cz; z < Mathf.Min(cz + CELL_NODES, graph.depth); z++) {
+					for (int x = cx; x < Mathf.Min(cx + CELL_NODES, graph.width); x++) {
+						GridNode node = graph.nodes[z * graph.width + x];
+						if (node.Tag == 0 || IsThreatTag(node.Tag)) node.Tag = (uint) levels[i];
+					}
+				}
+			}
+			tagsPending = false;
+			return true;
+		}));
+	}
+
+	private static bool IsThreatTag(uint tag){
+		return tag >= THREAT_TAG && tag < THREAT_TAG + THREAT_LEVELS.Length;
+	}
+}
@@ -1,9 +1,14 @@
 using UnityEngine;
 using System.Collections.Generic;
+using System.IO;
 
 public abstract class Player: MonoBehaviour  {
 
 	public string PLAYER_TAG ;
+	public int team = Teams.NONE; //Players with the same team are allies, NONE plays alone
+
+	[System.NonSerialized]
+	public int id = Teams.NONE; //See Teams
 	
 	private int MAX_SUPPLY = 250;
 	
@@ -15,9 +20,13 @@ public abstract class Player: MonoBehaviour  {
 	public Building mainBase;
 
 	public ResearchManager research;
+	public TechTree techTree = new TechTree();
+
+	//Resources or supply changed (eg: HUD)
+	public event System.Action changed;
 
 	public void Start(){
-		research = new ResearchManager();
+		research = new ResearchManager(techTree);
 	}
 
 	//cost: {mineral, gas, supplies}
@@ -37,6 +46,7 @@ public abstract class Player: MonoBehaviour  {
 	public bool consumeResources(int[] cost){
 		if (hasResources (cost) ) {
 			for(int i=0;i<resources.Length;i++) resources[i] -= cost[i];
+			Changed();
 			return true;
 		} 
 		return false;
@@ -44,18 +54,75 @@ public abstract class Player: MonoBehaviour  {
 	public bool consumeSupply(int[] cost){
 		if (hasSupply (cost) ) {
 			totalSupply += cost[cost.Length-1];
+			Changed();
 			return true;
 		}
 		return false;
 	}
 	public void addResources(int[] cost){
 		for(int i=0;i<resources.Length;i++) resources[i] += cost[i];
+		Changed();
 	}
 	public void addSupply(int[] cost){
 		totalSupply -= cost[cost.Length-1];
+		Changed();
 	}
 	public void incrSupply(int[] cost){
-		maxSupply = Mathf.Min(MAX_SUPPLY, maxSupply+cost[cost.Length-1]);
+		incrSupply(cost[cost.Length-1]);
+	}
+	/**
+	* Change the max supply, limited to MAX_SUPPLY. Returns the amount actually added
+	*/
+	public int incrSupply(int amount){
+		int previous = maxSupply;
+		maxSupply = Mathf.Min(MAX_SUPPLY, maxSupply+amount);
+		Changed();
+		return maxSupply - previous;
+	}
+
+	private void Changed(){
+		if (changed != null) changed();
+	}
+
+	// ------------------------------------
+	// SNAPSHOT
+	// ------------------------------------
+
+	/**
+	* Write the player state, see Snapshot
+	*/
+	public virtual void Save(BinaryWriter writer){
+		writer.Write(resources.Length);
+		foreach (int r in resources) writer.Write(r);
+		writer.Write(totalSupply);
+		writer.Write(maxSupply);
+
+		int researched = 0; //Bit per Research.Available
+		foreach (Research r in research.finished) researched |= 1 << (int) r.type;
+		writer.Write(researched);
+		writer.Write(mainBase != null ? mainBase.id : 0);
+	}
+
+	/**
+	* Read the player state, after the entities have been restored
+	*/
+	public virtual void Load(BinaryReader reader){
+		int count = reader.ReadInt32();
+		for (int i = 0; i < count; i++) resources[i] = reader.ReadInt32();
+		totalSupply = reader.ReadInt32();
+		maxSupply = reader.ReadInt32();
+
+		int researched = reader.ReadInt32();
+		if (research == null) research = new ResearchManager(techTree);
+		research.inProgress.Clear(); //Restored with the training queues
+		research.finished.Clear();
+		foreach (Research r in Object.FindObjectsOfType<Research>()) {
+			if ((researched & (1 << (int) r.type)) != 0 && !research.finished.Contains(r)) research.finished.Add(r);
+		}
+		research.Changed();
+
+		mainBase = Entities.Get<Building>(reader.ReadInt32());
+		Changed();
 	}
 	
 
@@ -0,0 +1,147 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Players by integer id, with precomputed alliances and the units of every player,
+* so the game queries compare ints and bitmasks instead of tags.
+*
+* Players get their id in registration order (player1 is 0, see Gameplay). Players with the same
+* team number are allies, team -1 plays alone (free for all). Masks have a bit per player id.
+*/
+public class Teams {
+
+	public const int MAX_PLAYERS = 8;
+	public const int NONE = -1;
+
+	private static Player[] players = new Player[MAX_PLAYERS];
+	private static int count = 0;
+	private static int[] allies = new int[MAX_PLAYERS]; //Including the player itself
+	private static int[] enemies = new int[MAX_PLAYERS];
+	private static List<Playable>[] units = NewUnits();
+	private static Dictionary<string, int> ids = new Dictionary<string, int>();
+
+	/**
+	* Add a player, returns its id
+	*/
+	public static int Register(Player player){
+		if (count == MAX_PLAYERS) throw new System.InvalidOperationException("More than " + MAX_PLAYERS + " players");
+
+		int id = count++;
+		players[id] = player;
+		player.id = id;
+		ids[player.PLAYER_TAG] = id;
+
+		//Alliance matrix
+		for (int other = 0; other < count; other++) {
+			bool allied = other == id || (player.team != NONE && players[other].team == player.team);
+			if (allied) {
+				allies[id] |= 1 << other;
+				allies[other] |= 1 << id;
+			} else {
+				enemies[id] |= 1 << other;
+				enemies[other] |= 1 << id;
+			}
+		}
+		return id;
+	}
+
+	public static int Count {
+		get { return count; }
+	}
+
+	/**
+	* Player with the id, null if none
+	*/
+	public static Player Get(int id){
+		if (id < 0 || id >= count) return null;
+		return players[id];
+	}
+
+	/**
+	* Id of the player with the tag, NONE if it's not a player. Resolve once, not in hot paths
+	*/
+	public static int Id(string tag){
+		int id;
+		if (tag == null || !ids.TryGetValue(tag, out id)) return NONE;
+		return id;
+	}
+
+	public static int AllyMask(int player){
+		return player < 0 ? 0 : allies[player];
+	}
+
+	public static int EnemyMask(int player){
+		return player < 0 ? 0 : enemies[player];
+	}
+
+	public static bool AreEnemies(int a, int b){
+		return a >= 0 && b >= 0 && (enemies[a] & (1 << b)) != 0;
+	}
+
+	// ------------------------------------
+	// UNITS
+	// ------------------------------------
+
+	/**
+	* Units and buildings of a player in the game, do not modify. Dead units stay until they are destroyed
+	*/
+	public static List<Playable> Units(int player){
+		return units[player];
+	}
+
+	/**
+	* Add the units of all the players in mask to result
+	*/
+	public static void Units(int mask, List<Playable> result){
+		for (int player = 0; mask != 0; player++, mask >>= 1) {
+			if ((mask & 1) != 0) result.AddRange(units[player]);
+		}
+	}
+
+	/**
+	* Called when an entity is registered (see Playable.register)
+	*/
+	public static void Add(Playable p){
+		if (p.owner < 0 || p.teamSlot >= 0) return;
+		List<Playable> list = units[p.owner];
+		p.teamSlot = list.Count;
+		list.Add(p);
+	}
+
+	/**
+	* Called when an entity is destroyed, swaps the last unit into its slot
+	*/
+	public static void Remove(Playable p){
+		if (p.owner < 0 || p.teamSlot < 0) return;
+		List<Playable> list = units[p.owner];
+		int slot = p.teamSlot;
+		p.teamSlot = -1;
+		if (slot >= list.Count || !object.ReferenceEquals(list[slot], p)) return; //Lists reset by a new game
+
+		Playable last = list[list.Count - 1];
+		list.RemoveAt(list.Count - 1);
+		if (object.ReferenceEquals(last, p)) return;
+		list[slot] = last;
+		last.teamSlot = slot;
+	}
+
+	/**
+	* Called when the level is unloaded
+	*/
+	public static void Reset(){
+		for (int i = 0; i < MAX_PLAYERS; i++) {
+			players[i] = null;
+			allies[i] = 0;
+			enemies[i] = 0;
+			units[i].Clear();
+		}
+		count = 0;
+		ids.Clear();
+	}
+
+	private static List<Playable>[] NewUnits(){
+		List<Playable>[] lists = new List<Playable>[MAX_PLAYERS];
+		for (int i = 0; i < MAX_PLAYERS; i++) lists[i] = new List<Playable>();
+		return lists;
+	}
+}
@@ -0,0 +1,68 @@
+using UnityEngine;
+using System.Collections.Generic;
+
+/**
+* Completed buildings and units of a player by type, to check the dependencies of what can be
+* built, trained or researched (see StrategyObject.dependencies) without looking up the scene.
+*
+* Buildings count when they are finished and units when they are created, both stop counting
+* when they die. Listeners of changed are called on every change (eg: build buttons).
+*/
+public class TechTree {
+
+	private static Dictionary<string, int> typeIds = new Dictionary<string, int>();
+
+	private List<int> counts = new List<int>(); //By type id
+	private HashSet<int> counted = new HashSet<int>(); //Entity ids
+
+	public int version { get; private set; }
+	public event System.Action changed;
+
+	/**
+	* Id of the type of an object, the same for a template and its instances (name without "(Clone)")
+	*/
+	public static int TypeId(string name){
+		int clone = name.IndexOf("(Clone)");
+		if (clone >= 0) name = name.Substring(0, clone);
+
+		int id;
+		if (!typeIds.TryGetValue(name, out id)) {
+			id = typeIds.Count;
+			typeIds.Add(name, id);
+		}
+		return id;
+	}
+
+	public void Added(Playable p){
+		if (p.id == 0 || !counted.Add(p.id)) return;
+		int type = p.TypeId;
+		while (counts.Count <= type) counts.Add(0);
+		counts[type]++;
+		Changed();
+	}
+
+	public void Removed(Playable p){
+		if (!counted.Remove(p.id)) return;
+		counts[p.TypeId]--;
+		Changed();
+	}
+
+	public int Count(int type){
+		return type < counts.Count ? counts[type] : 0;
+	}
+
+	public bool Satisfied(StrategyObject o){
+		foreach (Playable dep in o.dependencies) {
+			if (Count(dep.TypeId) == 0) return false;
+		}
+		return true;
+	}
+
+	/**
+	* Something else changed what can be developed (eg: a research started)
+	*/
+	public void Changed(){
+		version++;
+		if (changed != null) changed();
+	}
+}